@@ -0,0 +1,137 @@
+/*
+ ============================================================================
+ Name        : aleatorio_mpi.c
+ Description : Implementacion de Philox4x32-10 (ver aleatorio_mpi.h).
+ ============================================================================
+*/
+
+#include "aleatorio_mpi.h"
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_RONDAS 10
+
+#define CARRILES 16 /* bloques de 128 bits calculados juntos en el llenado masivo */
+
+/* ---------------------------------------------------------------
+ * Calcula nb bloques consecutivos a partir de 'primero'. Los
+ * contadores se guardan por columnas (una palabra por arreglo) para
+ * que cada ronda sea un bucle simple sobre los carriles: con -O2/-O3
+ * gcc y clang lo convierten en multiplicaciones 32x32->64 vectoriales.
+ * --------------------------------------------------------------- */
+static void philox_bloques(const aleatorio_t *g, uint64_t primero, int nb, uint32_t *salida)
+{
+    uint32_t c0[CARRILES], c1[CARRILES], c2[CARRILES], c3[CARRILES];
+    uint32_t k0 = g->clave[0], k1 = g->clave[1];
+    int j, ronda;
+
+    for (j = 0; j < nb; j++)
+    {
+        uint64_t b = primero + (uint64_t)j;
+        c0[j] = (uint32_t)b;
+        c1[j] = (uint32_t)(b >> 32);
+        c2[j] = g->flujo[0];
+        c3[j] = g->flujo[1];
+    }
+
+    for (ronda = 0; ronda < PHILOX_RONDAS; ronda++)
+    {
+        for (j = 0; j < nb; j++)
+        {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0[j];
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2[j];
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[j] ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[j] ^ k1;
+            c1[j] = (uint32_t)p1;
+            c3[j] = (uint32_t)p0;
+            c0[j] = n0;
+            c2[j] = n2;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (j = 0; j < nb; j++)
+    {
+        salida[4 * j] = c0[j];
+        salida[4 * j + 1] = c1[j];
+        salida[4 * j + 2] = c2[j];
+        salida[4 * j + 3] = c3[j];
+    }
+}
+
+void aleatorio_iniciar(aleatorio_t *g, uint64_t semilla, uint64_t flujo)
+{
+    g->clave[0] = (uint32_t)semilla;
+    g->clave[1] = (uint32_t)(semilla >> 32);
+    g->flujo[0] = (uint32_t)flujo;
+    g->flujo[1] = (uint32_t)(flujo >> 32);
+    g->posicion = 0;
+    g->bloque_id = UINT64_MAX;
+}
+
+void aleatorio_saltar(aleatorio_t *g, uint64_t posicion)
+{
+    g->posicion = posicion;
+}
+
+uint32_t aleatorio_u32(aleatorio_t *g)
+{
+    uint64_t b = g->posicion >> 2;
+
+    if (b != g->bloque_id)
+    {
+        philox_bloques(g, b, 1, g->bloque);
+        g->bloque_id = b;
+    }
+    return g->bloque[g->posicion++ & 3];
+}
+
+float aleatorio_uniforme(aleatorio_t *g)
+{
+    return (float)(aleatorio_u32(g) >> 8) * (1.0f / 16777216.0f);
+}
+
+void aleatorio_llenar_u32(aleatorio_t *g, uint32_t *destino, size_t n)
+{
+    size_t i = 0;
+    int nb;
+
+    /* hasta alinear con el inicio de un bloque */
+    while (i < n && (g->posicion & 3) != 0)
+        destino[i++] = aleatorio_u32(g);
+
+    /* bloques completos, CARRILES a la vez */
+    while (n - i >= 4)
+    {
+        nb = (int)((n - i) / 4);
+        if (nb > CARRILES)
+            nb = CARRILES;
+        philox_bloques(g, g->posicion >> 2, nb, destino + i);
+        i += 4 * (size_t)nb;
+        g->posicion += 4 * (uint64_t)nb;
+    }
+
+    /* resto */
+    while (i < n)
+        destino[i++] = aleatorio_u32(g);
+}
+
+void aleatorio_llenar_uniforme(aleatorio_t *g, float *destino, size_t n, float escala)
+{
+    uint32_t tmp[4 * CARRILES];
+    size_t i, j, cuantos;
+    float factor = escala * (1.0f / 16777216.0f);
+
+    for (i = 0; i < n; i += cuantos)
+    {
+        cuantos = n - i;
+        if (cuantos > 4 * CARRILES)
+            cuantos = 4 * CARRILES;
+        aleatorio_llenar_u32(g, tmp, cuantos);
+        for (j = 0; j < cuantos; j++)
+            destino[i + j] = (float)(tmp[j] >> 8) * factor;
+    }
+}
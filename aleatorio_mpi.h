@@ -0,0 +1,47 @@
+/*
+ ============================================================================
+ Name        : aleatorio_mpi.h
+ Description : Generador de numeros aleatorios basado en contador
+               (Philox4x32-10, Salmon et al., SC'11). La salida numero i del
+               flujo es una funcion pura de (semilla, flujo, i), por lo que
+               cualquier proceso puede saltar en O(1) a su tramo de un unico
+               flujo global: los resultados no dependen del numero de
+               procesos. No tiene estado oculto y es seguro entre hilos si
+               cada hilo usa su propio aleatorio_t.
+ ============================================================================
+*/
+
+#ifndef ALEATORIO_MPI_H
+#define ALEATORIO_MPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t clave[2];   /* derivada de la semilla                    */
+    uint32_t flujo[2];   /* palabras altas del contador               */
+    uint64_t posicion;   /* indice de la proxima salida de 32 bits    */
+    uint32_t bloque[4];  /* ultimo bloque calculado (acceso unitario) */
+    uint64_t bloque_id;  /* indice del bloque guardado, o UINT64_MAX  */
+} aleatorio_t;
+
+/* Inicializa el generador en la posicion 0 del flujo 'flujo' */
+void aleatorio_iniciar(aleatorio_t *g, uint64_t semilla, uint64_t flujo);
+
+/* Salta a la salida numero 'posicion' del flujo (O(1)) */
+void aleatorio_saltar(aleatorio_t *g, uint64_t posicion);
+
+uint32_t aleatorio_u32(aleatorio_t *g);
+
+/* Uniforme en [0, 1) con 24 bits de mantisa */
+float aleatorio_uniforme(aleatorio_t *g);
+
+/* Llenado masivo: n salidas consecutivas a partir de la posicion actual.
+ * Procesa varios contadores a la vez para que el compilador vectorice. */
+void aleatorio_llenar_u32(aleatorio_t *g, uint32_t *destino, size_t n);
+
+/* destino[i] = escala * uniforme[0,1) */
+void aleatorio_llenar_uniforme(aleatorio_t *g, float *destino, size_t n, float escala);
+
+#endif /* ALEATORIO_MPI_H */
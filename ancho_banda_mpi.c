@@ -3,12 +3,18 @@
  * DESCRIPTION:
  *   Provides point-to-point communications timings for any even
  *   number of MPI tasks.
+ *   With the argument "noncontiguo" it instead times non-contiguous
+ *   layouts (strided columns, separate x/y arrays and an array of
+ *   {x, y, w} records) sent through derived datatypes,
+ *   MPI_Pack/MPI_Unpack and manual staging buffers.
  * AUTHOR: Blaise Barney
  * LAST REVISED: 04/13/05
  ****************************************************************************/
 #include "mpi.h"
+#include "tiempo_mpi.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <time.h>
 
@@ -19,6 +25,291 @@
 #define INCREMENT 100000
 #define ROUNDTRIPS 100
 
+/* Non-contiguous mode: element counts (doubles) and strides to sweep */
+#define NC_ROUNDTRIPS 20
+#define NC_MAXDOUBLES (4 * 1024 * 1024) /* skip column cases with count*stride above this */
+static const int nc_counts[] = {1024, 16384, 131072};
+static const int nc_strides[] = {2, 16, 128};
+
+/* Ways of moving a layout; NC_CONTIG is the contiguous reference of equal size */
+#define NC_CONTIG 0
+#define NC_DATATYPE 1
+#define NC_PACK 2
+#define NC_MANUAL 3
+#define NC_SPLIT 4 /* x/y only: one message per array, as in minimos_cuadrados */
+#define NC_METHODS 5
+static const char *nc_names[NC_METHODS] = {"contiguous", "datatype", "MPI_Pack", "manual", "2 messages"};
+
+/* Layouts: NC_COLUMN is every stride-th double of buf; NC_XY is x[0..count)
+ * followed by y[0..count) (struct of arrays); NC_AOS sends x and y of each
+ * {x, y, w} record and leaves w (a local-only field) untouched */
+#define NC_COLUMN 0
+#define NC_XY 1
+#define NC_AOS 2
+static const char *nc_layouts[] = {"column", "x/y", "{x,y,w}"};
+
+typedef struct
+{
+    double x, y, w;
+} nc_point_t;
+
+typedef struct
+{
+    int layout, count, stride, elems, packsize;
+    double *buf, *x, *y, *staging;
+    nc_point_t *pts;
+    char *packbuf;
+    void *base;
+    MPI_Datatype type;
+} nc_layout_t;
+
+static void nc_create(nc_layout_t *L, int layout, int count, int stride)
+{
+    int i;
+    memset(L, 0, sizeof(*L));
+    L->layout = layout;
+    L->count = count;
+    L->stride = stride;
+    L->elems = (layout == NC_COLUMN) ? count : 2 * count;
+    L->staging = (double *)malloc(L->elems * sizeof(double));
+    if (layout == NC_COLUMN)
+    {
+        L->buf = (double *)malloc((size_t)count * stride * sizeof(double));
+        for (i = 0; i < count * stride; i++)
+            L->buf[i] = -1.0; /* gaps must never be written */
+        MPI_Type_vector(count, 1, stride, MPI_DOUBLE, &L->type);
+        L->base = L->buf;
+    }
+    else if (layout == NC_XY)
+    {
+        int blocklens[2] = {count, count};
+        MPI_Aint displs[2];
+        MPI_Datatype types[2] = {MPI_DOUBLE, MPI_DOUBLE};
+
+        L->x = (double *)calloc(count, sizeof(double));
+        L->y = (double *)calloc(count, sizeof(double));
+        MPI_Get_address(L->x, &displs[0]);
+        MPI_Get_address(L->y, &displs[1]);
+        MPI_Type_create_struct(2, blocklens, displs, types, &L->type);
+        L->base = MPI_BOTTOM;
+    }
+    else
+    {
+        /* one record's x and y, resized to the record extent so that
+         * count of them step over w */
+        int blocklens[2] = {1, 1};
+        MPI_Aint displs[2], origin;
+        MPI_Datatype types[2] = {MPI_DOUBLE, MPI_DOUBLE}, xy, record;
+
+        L->pts = (nc_point_t *)malloc(count * sizeof(nc_point_t));
+        for (i = 0; i < count; i++)
+            L->pts[i].x = L->pts[i].y = L->pts[i].w = -1.0; /* w must never be written */
+        MPI_Get_address(&L->pts[0], &origin);
+        MPI_Get_address(&L->pts[0].x, &displs[0]);
+        MPI_Get_address(&L->pts[0].y, &displs[1]);
+        displs[0] = MPI_Aint_diff(displs[0], origin);
+        displs[1] = MPI_Aint_diff(displs[1], origin);
+        MPI_Type_create_struct(2, blocklens, displs, types, &xy);
+        MPI_Type_create_resized(xy, 0, sizeof(nc_point_t), &record);
+        MPI_Type_contiguous(count, record, &L->type);
+        MPI_Type_free(&xy);
+        MPI_Type_free(&record);
+        L->base = L->pts;
+    }
+    MPI_Type_commit(&L->type);
+    MPI_Pack_size(1, L->type, MPI_COMM_WORLD, &L->packsize);
+    L->packbuf = (char *)malloc(L->packsize);
+}
+
+static void nc_free(nc_layout_t *L)
+{
+    MPI_Type_free(&L->type);
+    free(L->buf);
+    free(L->x);
+    free(L->y);
+    free(L->pts);
+    free(L->staging);
+    free(L->packbuf);
+}
+
+static double *nc_elem(nc_layout_t *L, int k)
+{
+    if (L->layout == NC_COLUMN)
+        return &L->buf[(size_t)k * L->stride];
+    if (L->layout == NC_AOS)
+        return (k % 2 == 0) ? &L->pts[k / 2].x : &L->pts[k / 2].y;
+    return (k < L->count) ? &L->x[k] : &L->y[k - L->count];
+}
+
+/* value 0 clears the payload before a checked receive; otherwise element k gets k+1 */
+static void nc_fill(nc_layout_t *L, int value)
+{
+    int k;
+    for (k = 0; k < L->elems; k++)
+        *nc_elem(L, k) = L->staging[k] = value ? (double)(k + 1) : 0.0;
+}
+
+static int nc_check(nc_layout_t *L, int method)
+{
+    int k, errors = 0;
+    for (k = 0; k < L->elems; k++)
+        if ((method == NC_CONTIG ? L->staging[k] : *nc_elem(L, k)) != (double)(k + 1))
+            errors++;
+    if (L->layout == NC_COLUMN)
+        for (k = 0; k < L->count * L->stride; k++)
+            if (k % L->stride != 0 && L->buf[k] != -1.0)
+                errors++;
+    if (L->layout == NC_AOS)
+        for (k = 0; k < L->count; k++)
+            if (L->pts[k].w != -1.0)
+                errors++;
+    return errors;
+}
+
+static void nc_send(nc_layout_t *L, int method, int peer, int tag)
+{
+    int k, pos = 0;
+    switch (method)
+    {
+    case NC_CONTIG:
+        MPI_Send(L->staging, L->elems, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD);
+        break;
+    case NC_DATATYPE:
+        MPI_Send(L->base, 1, L->type, peer, tag, MPI_COMM_WORLD);
+        break;
+    case NC_PACK:
+        MPI_Pack(L->base, 1, L->type, L->packbuf, L->packsize, &pos, MPI_COMM_WORLD);
+        MPI_Send(L->packbuf, pos, MPI_PACKED, peer, tag, MPI_COMM_WORLD);
+        break;
+    case NC_MANUAL:
+        if (L->layout == NC_COLUMN)
+            for (k = 0; k < L->count; k++)
+                L->staging[k] = L->buf[(size_t)k * L->stride];
+        else if (L->layout == NC_AOS)
+            for (k = 0; k < L->count; k++)
+            {
+                L->staging[2 * k] = L->pts[k].x;
+                L->staging[2 * k + 1] = L->pts[k].y;
+            }
+        else
+        {
+            memcpy(L->staging, L->x, L->count * sizeof(double));
+            memcpy(L->staging + L->count, L->y, L->count * sizeof(double));
+        }
+        MPI_Send(L->staging, L->elems, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD);
+        break;
+    case NC_SPLIT:
+        MPI_Send(L->x, L->count, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD);
+        MPI_Send(L->y, L->count, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD);
+        break;
+    }
+}
+
+static void nc_recv(nc_layout_t *L, int method, int peer, int tag)
+{
+    int k, pos = 0;
+    MPI_Status status;
+    switch (method)
+    {
+    case NC_CONTIG:
+        MPI_Recv(L->staging, L->elems, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD, &status);
+        break;
+    case NC_DATATYPE:
+        MPI_Recv(L->base, 1, L->type, peer, tag, MPI_COMM_WORLD, &status);
+        break;
+    case NC_PACK:
+        MPI_Recv(L->packbuf, L->packsize, MPI_PACKED, peer, tag, MPI_COMM_WORLD, &status);
+        MPI_Unpack(L->packbuf, L->packsize, &pos, L->base, 1, L->type, MPI_COMM_WORLD);
+        break;
+    case NC_MANUAL:
+        MPI_Recv(L->staging, L->elems, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD, &status);
+        if (L->layout == NC_COLUMN)
+            for (k = 0; k < L->count; k++)
+                L->buf[(size_t)k * L->stride] = L->staging[k];
+        else if (L->layout == NC_AOS)
+            for (k = 0; k < L->count; k++)
+            {
+                L->pts[k].x = L->staging[2 * k];
+                L->pts[k].y = L->staging[2 * k + 1];
+            }
+        else
+        {
+            memcpy(L->x, L->staging, L->count * sizeof(double));
+            memcpy(L->y, L->staging + L->count, L->count * sizeof(double));
+        }
+        break;
+    case NC_SPLIT:
+        MPI_Recv(L->x, L->count, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD, &status);
+        MPI_Recv(L->y, L->count, MPI_DOUBLE, peer, tag, MPI_COMM_WORLD, &status);
+        break;
+    }
+}
+
+/* Ping-pong of every method for one layout; task 0 prints avg MB/sec over pairs */
+static void nc_run(int rank, int numtasks, int partner, int layout, int count, int stride)
+{
+    int method, i, errors = 0, allerrors;
+    double t1, bw[NC_METHODS], avgbw[NC_METHODS];
+    nc_layout_t L;
+    char label[32];
+
+    nc_create(&L, layout, count, stride);
+    for (method = 0; method < NC_METHODS; method++)
+    {
+        bw[method] = 0.0;
+        if (layout != NC_XY && method == NC_SPLIT)
+            continue;
+        nc_fill(&L, 1);
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (rank < numtasks / 2)
+        {
+            /* first roundtrip is a checked warm-up */
+            nc_send(&L, method, partner, method);
+            nc_recv(&L, method, partner, method);
+            t1 = MPI_Wtime();
+            for (i = 1; i <= NC_ROUNDTRIPS; i++)
+            {
+                nc_send(&L, method, partner, method);
+                nc_recv(&L, method, partner, method);
+            }
+            bw[method] = (double)L.elems * sizeof(double) * 2 * NC_ROUNDTRIPS /
+                         (MPI_Wtime() - t1) / 1000000.0;
+        }
+        else
+        {
+            nc_fill(&L, 0);
+            nc_recv(&L, method, partner, method);
+            errors += nc_check(&L, method);
+            nc_send(&L, method, partner, method);
+            for (i = 1; i <= NC_ROUNDTRIPS; i++)
+            {
+                nc_recv(&L, method, partner, method);
+                nc_send(&L, method, partner, method);
+            }
+        }
+    }
+    MPI_Reduce(bw, avgbw, NC_METHODS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&errors, &allerrors, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank == 0)
+    {
+        if (layout == NC_COLUMN)
+            sprintf(label, "%d", stride);
+        else
+            sprintf(label, "-");
+        printf("%-7s %8d %6s", nc_layouts[layout], count, label);
+        for (method = 0; method < NC_METHODS; method++)
+        {
+            if (layout != NC_XY && method == NC_SPLIT)
+                printf(" %11s", "-");
+            else
+                printf(" %11.2f", avgbw[method] / (numtasks / 2));
+        }
+        printf("   %s\n", allerrors == 0 ? "OK" : "FAIL");
+    }
+    nc_free(&L);
+}
+
 int main(int argc, char *argv[])
 {
     int numtasks, rank, n, i, j, rndtrps, nbytes, start, end, incr,
@@ -26,7 +317,7 @@ int main(int argc, char *argv[])
     double thistime, bw, bestbw, worstbw, totalbw, avgbw,
         bestall, avgall, worstall,
         timings[MAXTASKS / 2][3], tmptimes[3],
-        resolution, t1, t2;
+        resolution, t1, t2, t_inicio;
     char msgbuf[ENDSIZE], host[MPI_MAX_PROCESSOR_NAME],
         hostmap[MAXTASKS][MPI_MAX_PROCESSOR_NAME];
     struct timeval tv1, tv2;
@@ -34,6 +325,7 @@ int main(int argc, char *argv[])
 
     /* Some initializations and error checking */
     MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
     MPI_Comm_size(MPI_COMM_WORLD, &numtasks);
     if (numtasks % 2 != 0)
     {
@@ -61,6 +353,37 @@ int main(int argc, char *argv[])
         dest = src = rank - numtasks / 2;
     MPI_Gather(&dest, 1, MPI_INT, &taskpairs, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
+    /************************ non-contiguous layouts mode ************************/
+    if (argc > 1 && strcmp(argv[1], "noncontiguo") == 0)
+    {
+        int c, st, m;
+        if (rank == 0)
+        {
+            printf("\n*************** MPI Non-contiguous Bandwidth Test ***************\n");
+            printf("column: MPI_Type_vector of doubles; x/y: two arrays in one\n");
+            printf("MPI_Type_create_struct; {x,y,w}: x and y of each record via\n");
+            printf("MPI_Type_create_struct + MPI_Type_create_resized (w not sent).\n");
+            printf("MB/sec of payload, avg over %d pairs,\n", numtasks / 2);
+            printf("%d roundtrips per case\n", NC_ROUNDTRIPS);
+            printf("*****************************************************************\n");
+            printf("%-7s %8s %6s", "layout", "doubles", "stride");
+            for (m = 0; m < NC_METHODS; m++)
+                printf(" %11s", nc_names[m]);
+            printf("   verif.\n");
+        }
+        for (c = 0; c < (int)(sizeof(nc_counts) / sizeof(nc_counts[0])); c++)
+        {
+            for (st = 0; st < (int)(sizeof(nc_strides) / sizeof(nc_strides[0])); st++)
+                if ((long)nc_counts[c] * nc_strides[st] <= NC_MAXDOUBLES)
+                    nc_run(rank, numtasks, dest, NC_COLUMN, nc_counts[c], nc_strides[st]);
+            nc_run(rank, numtasks, dest, NC_XY, nc_counts[c], 1);
+            nc_run(rank, numtasks, dest, NC_AOS, nc_counts[c], 1);
+        }
+        reportar_tiempo_pared("ancho_banda_mpi", t_inicio, MPI_COMM_WORLD);
+        MPI_Finalize();
+        return 0;
+    }
+
     if (rank == 0)
     {
         resolution = MPI_Wtick();
@@ -161,6 +484,7 @@ int main(int argc, char *argv[])
         }
     }
 
+    reportar_tiempo_pared("ancho_banda_mpi", t_inicio, MPI_COMM_WORLD);
     MPI_Finalize();
 
 } /* end of main */
@@ -2,21 +2,45 @@
 #include <stdio.h>
 #include <math.h>
 #include "mpi.h"
+#include "particion_mpi.h"
+#include "tiempo_mpi.h"
 
 #define f(x) ((4.0/ (1.0 + (x)*(x))))
 #define PI_REF (4.0 * atan(1.0))
 
+#define ARCHIVO_PESOS "aproximacion_pi.pesos" /* rendimientos de la ejecucion anterior */
+#define MUESTRA_CALIBRACION 2000000            /* intervalos de la calibracion inicial  */
+
+/* mismo calculo que el bucle principal, para medir el rendimiento de cada proceso */
+static double kernel_pi(long long cantidad, void *contexto)
+{
+    double ancho = 1.0 / (double) cantidad, suma = 0.0;
+    (void) contexto;
+    for (long long i = 0; i < cantidad; ++i) {
+        double x = ( (double)i + 0.5 ) * ancho;
+        suma += f(x);
+    }
+    return suma;
+}
+
 int main(int argc, char *argv[])
 {
     int tamaño, rango;
     int N;
     double ancho;
     double sumaLocal, sumaTotal;
+    double t_inicio, t_nucleo = 0.0;
+    particion_t particion;
     
     MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
     MPI_Comm_size(MPI_COMM_WORLD, &tamaño);
     MPI_Comm_rank(MPI_COMM_WORLD, &rango);
 
+    /* reparto segun el rendimiento: de la ejecucion anterior o de una calibracion corta */
+    if (!particion_crear(&particion, MPI_COMM_WORLD, ARCHIVO_PESOS)) {
+        particion_calibrar(&particion, kernel_pi, MUESTRA_CALIBRACION, NULL);
+    }
 
     while (1) {
         /* solo el proceso 0 lee de stdin */
@@ -32,42 +56,48 @@ int main(int argc, char *argv[])
 
         if (N <= 0) break; /* terminar si N==0 o lectura errónea */
 
+        /* tiempo de nucleo: reparto, calculo y reduccion (sin stdin ni calibracion) */
+        double t_n = MPI_Wtime();
+
         ancho = 1.0 / (double) N;
 
-        /* repartir índices [0..N-1] entre los 'tamaño' procesos */
-        int q = N / tamaño;        /* cociente */
-        int r = N % tamaño;        /* resto */
-        int local_n;               /* cuantos índices calcula este proceso */
-        int inicio;                /* índice inicial (desde 0) */
-
-        if (rango < r) {
-            local_n = q + 1;
-            inicio = rango * local_n;
-        } else {
-            local_n = q;
-            inicio = r * (q + 1) + (rango - r) * q;
-        }
+        /* repartir índices [0..N-1] proporcionalmente al rendimiento de cada proceso */
+        particion_repartir(&particion, N);
+        long long local_n = particion.cantidades[rango]; /* cuantos índices calcula este proceso */
+        long long inicio = particion.inicios[rango];     /* índice inicial (desde 0) */
 
         /* calcular suma local */
+        double t1 = MPI_Wtime();
         sumaLocal = 0.0;
-        for (int i = 0; i < local_n; ++i) {
-            int idx = inicio + i; /* índice global */
+        for (long long i = 0; i < local_n; ++i) {
+            long long idx = inicio + i; /* índice global */
             double x = ( (double)idx + 0.5 ) * ancho; /* punto medio */
             sumaLocal += f(x);
         }
+        double tLocal = MPI_Wtime() - t1;
 
         /* reducir sumas locales a la suma total en el proceso 0 */
         MPI_Reduce(&sumaLocal, &sumaTotal, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
 
+        /* medir el desbalance real y ajustar los pesos para el próximo N */
+        particion_rebalancear(&particion, tLocal);
+        t_nucleo += MPI_Wtime() - t_n;
+
         if (rango == 0) {
             double pi_approx = sumaTotal * ancho;
             double error = pi_approx - PI_REF;
             printf("N=%d procesos=%d pi_approx = %.12f error = %.12e\n",
                    N, tamaño, pi_approx, error);
+            particion_reportar(&particion, stdout);
         }
         /* aquí se repite el bucle: el proceso 0 pedirá otro N */
     }
 
+    particion_guardar(&particion, ARCHIVO_PESOS);
+    particion_liberar(&particion);
+
+    reportar_tiempo_nucleo("aproximacion_pi_solucion", t_nucleo, 0, MPI_COMM_WORLD);
+    reportar_tiempo_pared("aproximacion_pi_solucion", t_inicio, MPI_COMM_WORLD);
     MPI_Finalize();
     return 0;
 }
@@ -8,6 +8,7 @@
 
 #include <stdio.h>
 #include "mpi.h"
+#include "tiempo_mpi.h"
 #define LONGITUD_MENSAJE 2048 /* longitud del mensaje en elementos */
 #define ETIQUETA_A 100
 #define ETIQUETA_B 200
@@ -24,8 +25,10 @@ int main(int argc, char **argv)
         i;
     MPI_Status estado;   /* estado de comunicacion                   */
     MPI_Request reqs[2]; /* para guardar los request (send y recv)   */
+    double t_inicio;     /* tiempo de pared                          */
 
     MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
     MPI_Comm_rank(MPI_COMM_WORLD, &rango);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
@@ -102,6 +105,7 @@ int main(int argc, char **argv)
     MPI_Waitall(2, reqs, MPI_STATUSES_IGNORE);
     printf(" 2do metodo: Tarea %d ha recibido el mensaje\n", rango);
 
+    reportar_tiempo_pared("bloqueo_mutuo_corregido", t_inicio, MPI_COMM_WORLD);
     MPI_Finalize();
     return 0;
 }
@@ -1,7 +1,7 @@
 /*
  ============================================================================
  Name        : comunicacion_basica_solucion.c
- Compile     : mpicc -g comunicacion_basica_solucion.c -o comunicacion_basica_solucion.exe
+ Compile     : mpicc -g comunicacion_basica_solucion.c control_mpi.c -o comunicacion_basica_solucion.exe
  Run         : mpiexec  -n 4 ./comunicacion_basica_solucion
  ============================================================================
 */
@@ -11,40 +11,54 @@
 #include <string.h>
 #include <stdio.h>
 #include "mpi.h"
+#include "control_mpi.h"
+#include "tiempo_mpi.h"
+
+/* La raiz imprime cada respuesta en cuanto llega, sin esperar a las anteriores */
+static void hola_de_vuelta(int origen, const void *datos, void *contexto)
+{
+    int rango;
+
+    (void)origen;
+    (void)contexto;
+    memcpy(&rango, datos, sizeof(int));
+    printf("nodo %d : Hola de vuelta\n", rango);
+}
 
 int main(int argc, char **argv)
 {
     char mensaje1[20], mensaje2[20];
-    int i, rango, tamaño, tag1 = 1, tag2 = 2, etiqueta = 99;
-    MPI_Status estado;
+    int rango, tamaño;
+    control_t control;
+    double t_inicio;
 
     MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
     MPI_Comm_size(MPI_COMM_WORLD, &tamaño);
     MPI_Comm_rank(MPI_COMM_WORLD, &rango);
 
+    /* arbol por nodos: difusion entre lideres y luego dentro de cada nodo */
+    control_crear(MPI_COMM_WORLD, &control);
+
     if (rango == 0)
     {
         strcpy(mensaje1, "Hola, 1er mensaje");
         strcpy(mensaje2, "Hola, 2do mensaje");
-        for (i = 1; i < tamaño; i++)
-        {
-            MPI_Send(mensaje1, 20, MPI_CHAR, i, tag1, MPI_COMM_WORLD);
-            MPI_Send(mensaje2, 20, MPI_CHAR, i, tag2, MPI_COMM_WORLD);
-        }
-        printf("nodo %d : %.20s\n", rango, mensaje1);
-        printf("nodo %d : %.20s\n", rango, mensaje2);
-        for (i = 1; i < tamaño; i++)
-        {
-            MPI_Recv(&rango, 1, MPI_INT, i, etiqueta, MPI_COMM_WORLD, &estado);
-            printf("nodo %d : Hola de vuelta\n", rango);
-        }
     }
-    else
+    control_difundir(&control, mensaje1, 20, MPI_CHAR);
+    control_difundir(&control, mensaje2, 20, MPI_CHAR);
+
+    if (rango == 0)
     {
-        MPI_Recv(mensaje2, 20, MPI_CHAR, 0, tag2, MPI_COMM_WORLD, &estado);
-        MPI_Recv(mensaje1, 20, MPI_CHAR, 0, tag1, MPI_COMM_WORLD, &estado);
-        MPI_Send(&rango, 1, MPI_INT, 0, etiqueta, MPI_COMM_WORLD);
+        printf("nodo %d : %.20s\n", rango, mensaje1);
+        printf("nodo %d : %.20s\n", rango, mensaje2);
     }
+
+    /* respuestas en orden de llegada (MPI_ANY_SOURCE / MPI_Waitany) */
+    control_recolectar(&control, &rango, sizeof(int), hola_de_vuelta, NULL);
+
+    control_liberar(&control);
+    reportar_tiempo_pared("comunicacion_basica_solucion", t_inicio, MPI_COMM_WORLD);
     MPI_Finalize();
     return 0;
 }
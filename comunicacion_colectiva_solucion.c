@@ -1,33 +1,80 @@
 /*
  ============================================================================
  Name        : comunicacion_colectiva_solucion.c
- Compile     : mpicc -g comunicacion_colectiva_solucion.c -o comunicacion_colectiva_solucion.exe -lm
- Run         : mpiexec  -n 8 ./comunicacion_colectiva_solucion
+ Compile     : mpicc -g -O3 comunicacion_colectiva_solucion.c estadisticas_mpi.c aleatorio_mpi.c salida_mpi.c particion_mpi.c -o comunicacion_colectiva_solucion.exe -lm
+ Run         : mpiexec  -n 8 ./comunicacion_colectiva_solucion [muestras_totales] [texto|binario]
  ============================================================================
 */
 
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "mpi.h"
-
-void ObtenerEstadisticas(float *numeros_aleatorios, int n, float *valor_resultado);
+#include "estadisticas_mpi.h"
+#include "aleatorio_mpi.h"
+#include "salida_mpi.h"
+#include "particion_mpi.h"
+#include "tiempo_mpi.h"
+
+#define MUESTRAS_TOTALES 8000000LL /* muestras repartidas entre todas las tareas */
+#define TAM_BLOQUE 4096            /* muestras generadas por bloque              */
+#define FLUJO_INDIVIDUAL 0         /* un numero por tarea, indexado por id_tarea */
+#define FLUJO_MUESTRAS 1           /* flujo global de muestras                   */
+
+/* Registro del formato binario (datos_salida.bin): uno por tarea con sus
+ * estadisticas parciales y uno final con tarea = -1 con las globales */
+typedef struct
+{
+    int32_t tarea;
+    uint32_t semilla;
+    int64_t muestras;
+    double media;
+    double desv_estandar;
+    double min;
+    double max;
+    double aleatorio; /* numero individual de la tarea, o su media en el registro global */
+} registro_t;
 
 int main(int argc, char **argv)
 {
     int numero_tareas, id_tarea, ii;
     unsigned int semilla;
-    float numero_aleatorio[5], suma, valor_medio, numeros[100], valores_resultado[2];
-
-    MPI_Status estado;
-    FILE *archivo;
+    float numero_aleatorio[1], suma, valor_medio = 0.f, valores_resultado[2], *numeros, bloque[TAM_BLOQUE];
+    long long muestras_totales, mis_muestras, inicio, hechas, cuantas;
+    double t1, t_generacion, t_max, t_inicio, t_nucleo;
+    aleatorio_t generador;
+    estadisticas_t parciales, globales;
+    MPI_Datatype tipo_estadisticas;
+    MPI_Op op_estadisticas;
+
+    int binario;
+    registro_t registro;
+    salida_t salida;
+    particion_t particion;
 
     MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
     MPI_Comm_rank(MPI_COMM_WORLD, &id_tarea);
     MPI_Comm_size(MPI_COMM_WORLD, &numero_tareas);
 
-    archivo = fopen("datos_salida.data", "w");
+    muestras_totales = (argc > 1) ? atoll(argv[1]) : MUESTRAS_TOTALES;
+    if (muestras_totales < 1)
+        muestras_totales = MUESTRAS_TOTALES;
+
+    // Un solo MPI_File_open colectivo en vez de un fopen por tarea; cada tarea
+    // acumula lo suyo y se escribe todo junto al cerrar
+    binario = (argc > 2 && strcmp(argv[2], "binario") == 0);
+    if (salida_abrir(&salida, binario ? "datos_salida.bin" : "datos_salida.data", MPI_COMM_WORLD) != MPI_SUCCESS)
+    {
+        if (id_tarea == 0)
+            fprintf(stderr, "Error abriendo el archivo de salida\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (binario)
+        salida_cabecera(&salida, sizeof(registro_t));
 
     if (id_tarea == 0)
     {
@@ -37,8 +84,12 @@ int main(int argc, char **argv)
 
     MPI_Bcast(&semilla, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
 
-    srand(semilla + id_tarea);
-    numero_aleatorio[0] = 100. * (float)rand() / (float)RAND_MAX;
+    // Generador basado en contador: la salida i depende solo de (semilla, flujo, i),
+    // asi que cada tarea salta directo a su posicion y los numeros generados son
+    // los mismos para cualquier numero de tareas
+    aleatorio_iniciar(&generador, semilla, FLUJO_INDIVIDUAL);
+    aleatorio_saltar(&generador, id_tarea);
+    numero_aleatorio[0] = 100.f * aleatorio_uniforme(&generador);
 
     printf("\nTarea %d despues del broadcast: semilla = %u : aleatorio = %8.3f", id_tarea, semilla, numero_aleatorio[0]);
 
@@ -48,40 +99,65 @@ int main(int argc, char **argv)
     {
         valor_medio = suma / (float)numero_tareas;
         printf("\nTarea %d calcula el valor medio: suma = %8.3f - media = %8.3f", id_tarea, suma, valor_medio);
-        fprintf(archivo, "Para semilla = %d valor medio = %10.3f\n", semilla, valor_medio);
+        if (!binario)
+            salida_printf(&salida, "Para semilla = %d valor medio = %10.3f\n", semilla, valor_medio);
     }
 
-    for (ii = 1; ii < 5; ii++)
+    // Estadisticas en flujo + Allreduce con operacion definida por el usuario
+    //
+    // Cada tarea genera su parte de las muestras por bloques y acumula
+    // (cuenta, media, M2, min, max) sin guardarlas. Las parciales se combinan
+    // con una sola reduccion (Welford paralelo), asi cada tarea envia unos
+    // pocos bytes sin importar cuantas muestras tenga.
+
+    // Con pesos iguales particion_repartir da el mismo reparto q/r de bloques
+    particion_crear(&particion, MPI_COMM_WORLD, NULL);
+    particion_repartir(&particion, muestras_totales);
+    mis_muestras = particion.cantidades[id_tarea];
+    inicio = particion.inicios[id_tarea];
+    particion_liberar(&particion);
+
+    aleatorio_iniciar(&generador, semilla, FLUJO_MUESTRAS);
+    aleatorio_saltar(&generador, inicio);
+
+    t1 = MPI_Wtime();
+    estadisticas_iniciar(&parciales);
+    for (hechas = 0; hechas < mis_muestras; hechas += cuantas)
     {
-        numero_aleatorio[ii] = 100. * (float)rand() / (float)RAND_MAX;
+        cuantas = mis_muestras - hechas;
+        if (cuantas > TAM_BLOQUE)
+            cuantas = TAM_BLOQUE;
+        aleatorio_llenar_uniforme(&generador, bloque, cuantas, 100.f);
+        estadisticas_agregar_bloque(&parciales, bloque, cuantas);
     }
+    t_generacion = MPI_Wtime() - t1;
+    MPI_Reduce(&t_generacion, &t_max, 1, MPI_DOUBLE, MPI_MAX, numero_tareas - 1, MPI_COMM_WORLD);
 
-    // Uso de Gather + Bcast
+    printf("\nTarea %d: %lld muestras, media local = %8.3f, max local = %8.3f", id_tarea,
+           parciales.n, parciales.media, parciales.max);
 
-    printf("\nTarea %d (1:4) = ", id_tarea);
-    for (ii = 1; ii < 5; ii++)
-    {
-        printf(" %8.3f", numero_aleatorio[ii]);
-    }
+    // Nucleo: generacion + la reduccion de estadisticas (sin archivo ni impresiones)
+    t1 = MPI_Wtime();
+    estadisticas_mpi_crear(&tipo_estadisticas, &op_estadisticas);
+    MPI_Allreduce(&parciales, &globales, 1, tipo_estadisticas, op_estadisticas, MPI_COMM_WORLD);
+    estadisticas_mpi_liberar(&tipo_estadisticas, &op_estadisticas);
+    t_nucleo = t_generacion + (MPI_Wtime() - t1);
 
-    MPI_Gather(&numero_aleatorio[1], 4, MPI_FLOAT, numeros, 4, MPI_FLOAT, numero_tareas - 1, MPI_COMM_WORLD);
+    valores_resultado[0] = (float)globales.max;
+    valores_resultado[1] = (float)estadisticas_desv_estandar(&globales);
 
     if (id_tarea == (numero_tareas - 1))
     {
-        printf("\nTarea %d listando los numeros:", id_tarea);
-        for (ii = 0; ii < numero_tareas * 4; ii++)
-        {
-            printf(" %8.3f", numeros[ii]);
-        }
-
-        ObtenerEstadisticas(numeros, numero_tareas * 4, valores_resultado);
-        fprintf(archivo, " (Max, Desv.Est) = %10.3f%10.3f\n", valores_resultado[0], valores_resultado[1]);
+        printf("\nTarea %d: %lld muestras en total, media = %8.3f (%.1f millones de muestras/s)", id_tarea,
+               globales.n, globales.media, (double)globales.n / t_max / 1e6);
+        if (!binario)
+            salida_printf(&salida, " (Max, Desv.Est) = %10.3f%10.3f\n", valores_resultado[0], valores_resultado[1]);
     }
 
-    MPI_Bcast(valores_resultado, 2, MPI_FLOAT, numero_tareas - 1, MPI_COMM_WORLD);
     printf("\n en tarea %d (Max, Desv.Est.) = %10.3f%10.3f\n", id_tarea, valores_resultado[0], valores_resultado[1]);
 
     // Uso de Allgather
+    numeros = (float *)malloc(2 * numero_tareas * sizeof(float));
     MPI_Allgather(valores_resultado, 2, MPI_FLOAT, numeros, 2, MPI_FLOAT, MPI_COMM_WORLD);
 
     printf("\nTarea %d (0:1) = ", id_tarea);
@@ -94,34 +170,40 @@ int main(int argc, char **argv)
 
     if (id_tarea == (numero_tareas - 1))
     {
-        fprintf(archivo, " (Max, Desv.Est.) = %10.3f%10.3f\n", numeros[0], numeros[1]);
+        if (!binario)
+            salida_printf(&salida, " (Max, Desv.Est.) = %10.3f%10.3f\n", numeros[0], numeros[1]);
     }
 
-    fclose(archivo);
-    MPI_Finalize();
-
-    return 0;
-}
-
-void ObtenerEstadisticas(float *numeros_aleatorios, int N, float *datos_salida)
-{
-    float suma, valor_medio, desv_estandar;
-    int ii;
-
-    suma = 0.;
-    *datos_salida = 0.;
-
-    for (ii = 0; ii < N; ii++)
+    if (binario)
     {
-        suma += *(numeros_aleatorios + ii);
-        if (*(numeros_aleatorios + ii) > *datos_salida)
-            *datos_salida = *(numeros_aleatorios + ii);
+        registro.tarea = id_tarea;
+        registro.semilla = semilla;
+        registro.muestras = parciales.n;
+        registro.media = parciales.media;
+        registro.desv_estandar = estadisticas_desv_estandar(&parciales);
+        registro.min = parciales.min;
+        registro.max = parciales.max;
+        registro.aleatorio = numero_aleatorio[0];
+        salida_agregar(&salida, &registro, sizeof(registro));
+
+        if (id_tarea == (numero_tareas - 1))
+        {
+            registro.tarea = -1;
+            registro.muestras = globales.n;
+            registro.media = globales.media;
+            registro.desv_estandar = estadisticas_desv_estandar(&globales);
+            registro.min = globales.min;
+            registro.max = globales.max;
+            registro.aleatorio = valor_medio;
+            salida_agregar(&salida, &registro, sizeof(registro));
+        }
     }
 
-    valor_medio = suma / (float)N;
-    desv_estandar = 0.;
-    for (ii = 0; ii < N; ii++)
-        desv_estandar += (*(numeros_aleatorios + ii) - valor_medio) * (*(numeros_aleatorios + ii) - valor_medio);
+    free(numeros);
+    salida_cerrar(&salida);
+    reportar_tiempo_nucleo("comunicacion_colectiva_solucion", t_nucleo, 0, MPI_COMM_WORLD);
+    reportar_tiempo_pared("comunicacion_colectiva_solucion", t_inicio, MPI_COMM_WORLD);
+    MPI_Finalize();
 
-    *(datos_salida + 1) = sqrt(desv_estandar / (float)N);
-}
\ No newline at end of file
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+ ============================================================================
+ Name        : control_mpi.c
+ Description : Implementacion de la mensajeria de control jerarquica
+               (ver control_mpi.h).
+ ============================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "control_mpi.h"
+
+#define ETIQUETA_RESPUESTA 300 /* proceso -> lider de su nodo */
+#define ETIQUETA_NODO 301      /* lider -> raiz               */
+
+int control_crear(MPI_Comm comm, control_t *c)
+{
+    const char *simulados = getenv("CONTROL_PROCESOS_POR_NODO");
+    int rc;
+
+    c->tamanos_nodos = NULL;
+    rc = MPI_Comm_dup(comm, &c->comm);
+    if (rc != MPI_SUCCESS)
+        return rc;
+    MPI_Comm_rank(c->comm, &c->rango);
+    MPI_Comm_size(c->comm, &c->tamano);
+
+    /* la clave = rango garantiza que la raiz sea el rango 0 de su nodo (y lider) */
+    if (simulados != NULL && atoi(simulados) > 0)
+        rc = MPI_Comm_split(c->comm, c->rango / atoi(simulados), c->rango, &c->nodo);
+    else
+        rc = MPI_Comm_split_type(c->comm, MPI_COMM_TYPE_SHARED, c->rango, MPI_INFO_NULL, &c->nodo);
+    if (rc != MPI_SUCCESS)
+        return rc;
+    MPI_Comm_rank(c->nodo, &c->rango_nodo);
+    MPI_Comm_size(c->nodo, &c->tamano_nodo);
+
+    rc = MPI_Comm_split(c->comm, (c->rango_nodo == 0) ? 0 : MPI_UNDEFINED, c->rango, &c->lideres);
+    if (rc != MPI_SUCCESS)
+        return rc;
+
+    /* la raiz necesita saber cuantas respuestas trae el mensaje de cada lider */
+    if (c->lideres != MPI_COMM_NULL)
+    {
+        MPI_Comm_size(c->lideres, &c->num_nodos);
+        if (c->rango == 0)
+            c->tamanos_nodos = (int *)malloc(c->num_nodos * sizeof(int));
+        MPI_Gather(&c->tamano_nodo, 1, MPI_INT, c->tamanos_nodos, 1, MPI_INT, 0, c->lideres);
+    }
+    return MPI_Bcast(&c->num_nodos, 1, MPI_INT, 0, c->nodo);
+}
+
+int control_difundir(control_t *c, void *buf, int cuenta, MPI_Datatype tipo)
+{
+    int rc = MPI_SUCCESS;
+
+    /* entre nodos: arbol de MPI_Bcast sobre los lideres */
+    if (c->lideres != MPI_COMM_NULL && c->num_nodos > 1)
+        rc = MPI_Bcast(buf, cuenta, tipo, 0, c->lideres);
+    if (rc != MPI_SUCCESS)
+        return rc;
+
+    /* dentro del nodo: el lider entrega por memoria compartida */
+    if (c->tamano_nodo > 1)
+        rc = MPI_Bcast(buf, cuenta, tipo, 0, c->nodo);
+    return rc;
+}
+
+/* Cada respuesta viaja como [rango de origen (int)][bytes de datos] */
+static void procesar_mensaje(const char *mensaje, int registros, int tam_registro,
+                             control_respuesta_fn fn, void *contexto)
+{
+    int i, origen;
+
+    for (i = 0; i < registros; i++)
+    {
+        memcpy(&origen, mensaje + (size_t)i * tam_registro, sizeof(int));
+        fn(origen, mensaje + (size_t)i * tam_registro + sizeof(int), contexto);
+    }
+}
+
+int control_recolectar(control_t *c, const void *respuesta, int bytes,
+                       control_respuesta_fn fn, void *contexto)
+{
+    int tam_registro = (int)sizeof(int) + bytes, i, n, indice, cuenta, registros, pendientes;
+    int rc = MPI_SUCCESS;
+    int *restantes_por_req;
+    char *buffer, **inicio_req;
+    MPI_Request *reqs;
+    MPI_Status estado;
+    size_t desplazamiento;
+
+    if (c->rango != 0 && c->rango_nodo != 0)
+    {
+        /* proceso comun: una respuesta a su lider */
+        buffer = (char *)malloc(tam_registro);
+        memcpy(buffer, &c->rango, sizeof(int));
+        memcpy(buffer + sizeof(int), respuesta, bytes);
+        rc = MPI_Send(buffer, tam_registro, MPI_BYTE, 0, ETIQUETA_RESPUESTA, c->nodo);
+        free(buffer);
+        return rc;
+    }
+
+    if (c->rango != 0)
+    {
+        /* ---------------------------------------------------------------
+         * lider: reenvia a la raiz, en lotes parciales, lo que cada
+         * MPI_Waitsome entrega de su nodo (su propia respuesta va en el
+         * primer lote); un proceso lento solo retiene su propio registro
+         * --------------------------------------------------------------- */
+        int completadas, en_lote, *indices;
+        char *lote;
+
+        pendientes = c->tamano_nodo - 1;
+        buffer = (char *)malloc((size_t)(pendientes > 0 ? pendientes : 1) * tam_registro);
+        lote = (char *)malloc((size_t)c->tamano_nodo * tam_registro);
+        reqs = (MPI_Request *)malloc(c->tamano_nodo * sizeof(MPI_Request));
+        indices = (int *)malloc(c->tamano_nodo * sizeof(int));
+        memcpy(lote, &c->rango, sizeof(int));
+        memcpy(lote + sizeof(int), respuesta, bytes);
+        en_lote = 1;
+        for (i = 0; i < pendientes; i++)
+            MPI_Irecv(buffer + (size_t)i * tam_registro, tam_registro, MPI_BYTE, MPI_ANY_SOURCE,
+                      ETIQUETA_RESPUESTA, c->nodo, &reqs[i]);
+        do
+        {
+            if (pendientes > 0)
+            {
+                rc = MPI_Waitsome(c->tamano_nodo - 1, reqs, &completadas, indices, MPI_STATUSES_IGNORE);
+                if (rc != MPI_SUCCESS || completadas == MPI_UNDEFINED)
+                    break;
+                for (i = 0; i < completadas; i++, en_lote++)
+                    memcpy(lote + (size_t)en_lote * tam_registro, buffer + (size_t)indices[i] * tam_registro,
+                           tam_registro);
+                pendientes -= completadas;
+            }
+            rc = MPI_Send(lote, en_lote * tam_registro, MPI_BYTE, 0, ETIQUETA_NODO, c->lideres);
+            en_lote = 0;
+        } while (rc == MPI_SUCCESS && pendientes > 0);
+        free(indices);
+        free(reqs);
+        free(lote);
+        free(buffer);
+        return rc;
+    }
+
+    /* ---------------------------------------------------------------
+     * raiz: una recepcion por cada proceso de su nodo (ANY_SOURCE) y
+     * una por cada otro nodo; se atienden con MPI_Waitany a medida que
+     * terminan. Los lideres mandan lotes parciales: el tamano del lote
+     * sale de MPI_Get_count y, si a ese nodo le faltan respuestas, se
+     * vuelve a publicar la recepcion a continuacion de lo ya recibido
+     * --------------------------------------------------------------- */
+    n = (c->tamano_nodo - 1) + (c->num_nodos - 1);
+    if (n == 0)
+        return MPI_SUCCESS;
+    buffer = (char *)malloc((size_t)(c->tamano - 1) * tam_registro);
+    reqs = (MPI_Request *)malloc(n * sizeof(MPI_Request));
+    restantes_por_req = (int *)malloc(n * sizeof(int));
+    inicio_req = (char **)malloc(n * sizeof(char *));
+
+    desplazamiento = 0;
+    for (i = 0; i < c->tamano_nodo - 1; i++)
+    {
+        inicio_req[i] = buffer + desplazamiento;
+        restantes_por_req[i] = 1;
+        MPI_Irecv(inicio_req[i], tam_registro, MPI_BYTE, MPI_ANY_SOURCE, ETIQUETA_RESPUESTA,
+                  c->nodo, &reqs[i]);
+        desplazamiento += tam_registro;
+    }
+    for (i = 1; i < c->num_nodos; i++)
+    {
+        int k = c->tamano_nodo - 1 + i - 1;
+        inicio_req[k] = buffer + desplazamiento;
+        restantes_por_req[k] = c->tamanos_nodos[i];
+        MPI_Irecv(inicio_req[k], c->tamanos_nodos[i] * tam_registro, MPI_BYTE, i, ETIQUETA_NODO,
+                  c->lideres, &reqs[k]);
+        desplazamiento += (size_t)c->tamanos_nodos[i] * tam_registro;
+    }
+
+    for (pendientes = c->tamano - 1; pendientes > 0; pendientes -= registros)
+    {
+        rc = MPI_Waitany(n, reqs, &indice, &estado);
+        if (rc != MPI_SUCCESS || indice == MPI_UNDEFINED)
+            break;
+        MPI_Get_count(&estado, MPI_BYTE, &cuenta);
+        registros = cuenta / tam_registro;
+        procesar_mensaje(inicio_req[indice], registros, tam_registro, fn, contexto);
+        restantes_por_req[indice] -= registros;
+        inicio_req[indice] += (size_t)registros * tam_registro;
+        if (restantes_por_req[indice] > 0)
+            MPI_Irecv(inicio_req[indice], restantes_por_req[indice] * tam_registro, MPI_BYTE,
+                      estado.MPI_SOURCE, ETIQUETA_NODO, c->lideres, &reqs[indice]);
+    }
+
+    free(inicio_req);
+    free(restantes_por_req);
+    free(reqs);
+    free(buffer);
+    return rc;
+}
+
+void control_liberar(control_t *c)
+{
+    free(c->tamanos_nodos);
+    c->tamanos_nodos = NULL;
+    if (c->lideres != MPI_COMM_NULL)
+        MPI_Comm_free(&c->lideres);
+    MPI_Comm_free(&c->nodo);
+    MPI_Comm_free(&c->comm);
+}
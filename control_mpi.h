@@ -0,0 +1,54 @@
+/*
+ ============================================================================
+ Name        : control_mpi.h
+ Description : Mensajeria de control raiz -> todos y todos -> raiz con
+               conocimiento de nodos. Los procesos se agrupan por nodo con
+               MPI_Comm_split_type(MPI_COMM_TYPE_SHARED); el rango 0 de cada
+               nodo es su lider.
+                 - difusion: arbol entre lideres (MPI_Bcast) y luego entrega
+                   dentro del nodo
+                 - recoleccion: cada lider reenvia las respuestas de su nodo
+                   en orden de llegada (MPI_ANY_SOURCE), en lotes parciales
+                   segun lo que entrega cada MPI_Waitsome, y la raiz las
+                   procesa en orden de llegada (MPI_Waitany)
+               La raiz es el rango 0 del comunicador.
+               Para probar el arbol en un solo nodo se puede fijar la variable
+               de entorno CONTROL_PROCESOS_POR_NODO (nodos simulados).
+ ============================================================================
+*/
+
+#ifndef CONTROL_MPI_H
+#define CONTROL_MPI_H
+
+#include "mpi.h"
+
+typedef struct
+{
+    MPI_Comm comm;     /* copia del comunicador original            */
+    MPI_Comm nodo;     /* procesos del mismo nodo                   */
+    MPI_Comm lideres;  /* un proceso por nodo; MPI_COMM_NULL si no es lider */
+    int rango, tamano;
+    int rango_nodo, tamano_nodo;
+    int num_nodos;
+    int *tamanos_nodos; /* solo en la raiz: procesos de cada nodo (por rango en 'lideres') */
+} control_t;
+
+/* Funcion que la raiz llama por cada respuesta recibida */
+typedef void (*control_respuesta_fn)(int origen, const void *datos, void *contexto);
+
+/* Colectiva */
+int control_crear(MPI_Comm comm, control_t *c);
+
+/* Colectiva: 'buf' de la raiz llega a todos */
+int control_difundir(control_t *c, void *buf, int cuenta, MPI_Datatype tipo);
+
+/*
+ * Colectiva: cada proceso distinto de la raiz aporta 'bytes' bytes en 'respuesta';
+ * la raiz llama a 'fn' una vez por proceso, en el orden en que llegan.
+ */
+int control_recolectar(control_t *c, const void *respuesta, int bytes,
+                       control_respuesta_fn fn, void *contexto);
+
+void control_liberar(control_t *c);
+
+#endif /* CONTROL_MPI_H */
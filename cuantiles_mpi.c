@@ -0,0 +1,370 @@
+/*
+ ============================================================================
+ Name        : cuantiles_mpi.c
+ Description : Implementacion de las estadisticas de orden distribuidas
+               (ver cuantiles_mpi.h).
+ ============================================================================
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include "cuantiles_mpi.h"
+#include "aleatorio_mpi.h"
+
+#define BOCETO_SEMILLA 0x5EED5EEDu /* prioridades: independientes de la semilla de los datos */
+#define BLOQUE_PRIORIDADES 1024
+
+/* ---------------------------------------------------------------
+ * Claves sin signo que conservan el orden de los float (32 bits) y
+ * de los double (64 bits): negativos -> se invierten todos los bits,
+ * positivos -> se enciende el bit de signo. Asi comparar claves sin
+ * signo equivale a comparar los valores.
+ * --------------------------------------------------------------- */
+static uint32_t clave_de(float x)
+{
+    uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+static float float_de(uint32_t clave)
+{
+    uint32_t u = (clave & 0x80000000u) ? (clave & 0x7FFFFFFFu) : ~clave;
+    float x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+#define SIGNO_64 0x8000000000000000ull
+
+static uint64_t clave64_de(double x)
+{
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    return (u & SIGNO_64) ? ~u : (u | SIGNO_64);
+}
+
+static double double_de(uint64_t clave)
+{
+    uint64_t u = (clave & SIGNO_64) ? (clave & ~SIGNO_64) : ~clave;
+    double x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+/* clave del elemento i: 'bits' = 32 para float, 64 para double */
+static uint64_t clave_en(const void *datos, int bits, long long i)
+{
+    return (bits == 32) ? clave_de(((const float *)datos)[i]) : clave64_de(((const double *)datos)[i]);
+}
+
+/* ---------------------------------------------------------------
+ * Seleccion paralela. En cada pasada se fijan 8 bits mas de la
+ * clave buscada: cada proceso cuenta, entre los elementos que aun
+ * comparten el prefijo ya fijado, cuantos caen en cada una de las
+ * 256 cubetas; la suma global indica en que cubeta esta el
+ * elemento k-esimo y cuantos elementos quedan por debajo.
+ * Devuelve en 'prefijo' la clave de cada cuantil.
+ * --------------------------------------------------------------- */
+static int seleccion_paralela(const void *datos, int bits, long long n, const double *p, int nq,
+                              uint64_t *prefijo, MPI_Comm comm)
+{
+    long long total, k[CUANTILES_MAX], *cuentas, *cuentas_globales, acumulado;
+    uint64_t clave;
+    int pasada, desplazamiento, j, b, rc;
+    long long i;
+
+    if (nq < 1 || nq > CUANTILES_MAX)
+        return MPI_ERR_ARG;
+
+    rc = MPI_Allreduce(&n, &total, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    if (rc != MPI_SUCCESS)
+        return rc;
+    if (total == 0)
+        return MPI_ERR_COUNT;
+
+    for (j = 0; j < nq; j++)
+    {
+        double pj = (p[j] < 0.0) ? 0.0 : (p[j] > 1.0 ? 1.0 : p[j]);
+        k[j] = (long long)floor(pj * (double)(total - 1));
+        prefijo[j] = 0;
+    }
+
+    cuentas = (long long *)malloc(2 * (size_t)nq * 256 * sizeof(long long));
+    if (cuentas == NULL)
+        return MPI_ERR_NO_MEM;
+    cuentas_globales = cuentas + (size_t)nq * 256;
+
+    for (pasada = 0; pasada < bits / 8; pasada++)
+    {
+        desplazamiento = bits - 8 - 8 * pasada;
+        memset(cuentas, 0, (size_t)nq * 256 * sizeof(long long));
+
+        if (pasada == 0)
+        {
+            /* sin prefijo: un solo histograma sirve para todos los cuantiles */
+            for (i = 0; i < n; i++)
+                cuentas[clave_en(datos, bits, i) >> desplazamiento]++;
+            for (j = 1; j < nq; j++)
+                memcpy(cuentas + (size_t)j * 256, cuentas, 256 * sizeof(long long));
+        }
+        else
+        {
+            for (i = 0; i < n; i++)
+            {
+                clave = clave_en(datos, bits, i);
+                for (j = 0; j < nq; j++)
+                    if ((clave >> (desplazamiento + 8)) == (prefijo[j] >> (desplazamiento + 8)))
+                        cuentas[(size_t)j * 256 + ((clave >> desplazamiento) & 0xFF)]++;
+            }
+        }
+
+        rc = MPI_Allreduce(cuentas, cuentas_globales, nq * 256, MPI_LONG_LONG, MPI_SUM, comm);
+        if (rc != MPI_SUCCESS)
+        {
+            free(cuentas);
+            return rc;
+        }
+
+        for (j = 0; j < nq; j++)
+        {
+            acumulado = 0;
+            for (b = 0; b < 256; b++)
+            {
+                long long c = cuentas_globales[(size_t)j * 256 + b];
+                if (k[j] < acumulado + c)
+                    break;
+                acumulado += c;
+            }
+            prefijo[j] |= (uint64_t)b << desplazamiento;
+            k[j] -= acumulado;
+        }
+    }
+
+    free(cuentas);
+    return MPI_SUCCESS;
+}
+
+int cuantiles_exactos(const float *datos, long long n, const double *p, int nq,
+                      float *resultado, MPI_Comm comm)
+{
+    uint64_t prefijo[CUANTILES_MAX];
+    int j, rc = seleccion_paralela(datos, 32, n, p, nq, prefijo, comm);
+
+    if (rc == MPI_SUCCESS)
+        for (j = 0; j < nq; j++)
+            resultado[j] = float_de((uint32_t)prefijo[j]);
+    return rc;
+}
+
+int cuantiles_exactos_double(const double *datos, long long n, const double *p, int nq,
+                             double *resultado, MPI_Comm comm)
+{
+    uint64_t prefijo[CUANTILES_MAX];
+    int j, rc = seleccion_paralela(datos, 64, n, p, nq, prefijo, comm);
+
+    if (rc == MPI_SUCCESS)
+        for (j = 0; j < nq; j++)
+            resultado[j] = double_de(prefijo[j]);
+    return rc;
+}
+
+/* ---------------------------------------------------------------
+ * Boceto: muestra bottom-k. Se construye con un monticulo de maximos
+ * sobre la prioridad y al final se ordena de menor a mayor, que es la
+ * forma que espera boceto_combinar.
+ * --------------------------------------------------------------- */
+static void hundir(uint32_t *prio, float *val, int n, int i)
+{
+    int hijo;
+    uint32_t tp;
+    float tv;
+
+    for (;;)
+    {
+        hijo = 2 * i + 1;
+        if (hijo >= n)
+            break;
+        if (hijo + 1 < n && prio[hijo + 1] > prio[hijo])
+            hijo++;
+        if (prio[i] >= prio[hijo])
+            break;
+        tp = prio[i];
+        prio[i] = prio[hijo];
+        prio[hijo] = tp;
+        tv = val[i];
+        val[i] = val[hijo];
+        val[hijo] = tv;
+        i = hijo;
+    }
+}
+
+void boceto_construir(boceto_t *b, const float *datos, long long n, long long inicio_global)
+{
+    uint32_t prioridades[BLOQUE_PRIORIDADES], tp;
+    aleatorio_t generador;
+    long long i;
+    int j, cuantas, m, hijo, padre;
+    float tv;
+
+    b->n = 0;
+    aleatorio_iniciar(&generador, BOCETO_SEMILLA, 0);
+    aleatorio_saltar(&generador, (uint64_t)inicio_global);
+
+    for (i = 0; i < n; i += cuantas)
+    {
+        cuantas = (n - i > BLOQUE_PRIORIDADES) ? BLOQUE_PRIORIDADES : (int)(n - i);
+        aleatorio_llenar_u32(&generador, prioridades, cuantas);
+        for (j = 0; j < cuantas; j++)
+        {
+            if (b->n < BOCETO_K)
+            {
+                /* subir el nuevo elemento en el monticulo */
+                hijo = b->n++;
+                b->prioridad[hijo] = prioridades[j];
+                b->valor[hijo] = datos[i + j];
+                while (hijo > 0)
+                {
+                    padre = (hijo - 1) / 2;
+                    if (b->prioridad[padre] >= b->prioridad[hijo])
+                        break;
+                    tp = b->prioridad[padre];
+                    b->prioridad[padre] = b->prioridad[hijo];
+                    b->prioridad[hijo] = tp;
+                    tv = b->valor[padre];
+                    b->valor[padre] = b->valor[hijo];
+                    b->valor[hijo] = tv;
+                    hijo = padre;
+                }
+            }
+            else if (prioridades[j] < b->prioridad[0])
+            {
+                b->prioridad[0] = prioridades[j];
+                b->valor[0] = datos[i + j];
+                hundir(b->prioridad, b->valor, b->n, 0);
+            }
+        }
+    }
+
+    /* ordenar ascendentemente por prioridad (heapsort sobre el monticulo) */
+    for (m = b->n - 1; m > 0; m--)
+    {
+        tp = b->prioridad[0];
+        b->prioridad[0] = b->prioridad[m];
+        b->prioridad[m] = tp;
+        tv = b->valor[0];
+        b->valor[0] = b->valor[m];
+        b->valor[m] = tv;
+        hundir(b->prioridad, b->valor, m, 0);
+    }
+}
+
+void boceto_combinar(boceto_t *a, const boceto_t *b)
+{
+    uint32_t prio[BOCETO_K];
+    float val[BOCETO_K];
+    int i = 0, j = 0, m = 0;
+
+    while (m < BOCETO_K && (i < a->n || j < b->n))
+    {
+        if (j >= b->n || (i < a->n && a->prioridad[i] <= b->prioridad[j]))
+        {
+            prio[m] = a->prioridad[i];
+            val[m++] = a->valor[i++];
+        }
+        else
+        {
+            prio[m] = b->prioridad[j];
+            val[m++] = b->valor[j++];
+        }
+    }
+    memcpy(a->prioridad, prio, m * sizeof(uint32_t));
+    memcpy(a->valor, val, m * sizeof(float));
+    a->n = m;
+}
+
+static int comparar_float(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+float boceto_cuantil(const boceto_t *b, double p)
+{
+    float ordenados[BOCETO_K];
+    long long k;
+
+    if (b->n == 0)
+        return 0.0f;
+    memcpy(ordenados, b->valor, b->n * sizeof(float));
+    qsort(ordenados, b->n, sizeof(float), comparar_float);
+    if (p < 0.0)
+        p = 0.0;
+    if (p > 1.0)
+        p = 1.0;
+    k = (long long)floor(p * (double)(b->n - 1));
+    return ordenados[k];
+}
+
+static void combinar_mpi(void *entrada, void *entrada_salida, int *longitud, MPI_Datatype *tipo)
+{
+    const boceto_t *in = (const boceto_t *)entrada;
+    boceto_t *inout = (boceto_t *)entrada_salida;
+    int i;
+
+    (void)tipo;
+    for (i = 0; i < *longitud; i++)
+        boceto_combinar(&inout[i], &in[i]);
+}
+
+void boceto_mpi_crear(MPI_Datatype *tipo, MPI_Op *op)
+{
+    int longitudes[3] = {1, BOCETO_K, BOCETO_K};
+    MPI_Aint desplazamientos[3] = {offsetof(boceto_t, n), offsetof(boceto_t, prioridad),
+                                   offsetof(boceto_t, valor)};
+    MPI_Datatype tipos[3] = {MPI_INT, MPI_UINT32_T, MPI_FLOAT}, tmp;
+
+    MPI_Type_create_struct(3, longitudes, desplazamientos, tipos, &tmp);
+    MPI_Type_create_resized(tmp, 0, sizeof(boceto_t), tipo);
+    MPI_Type_free(&tmp);
+    MPI_Type_commit(tipo);
+
+    MPI_Op_create(combinar_mpi, 1, op);
+}
+
+void boceto_mpi_liberar(MPI_Datatype *tipo, MPI_Op *op)
+{
+    MPI_Op_free(op);
+    MPI_Type_free(tipo);
+}
+
+int histograma_mpi(const float *datos, long long n, float min, float max, int cubetas,
+                   long long *cuentas, int raiz, MPI_Comm comm)
+{
+    long long *locales, i;
+    double escala;
+    int c, rc;
+
+    if (cubetas < 1)
+        return MPI_ERR_ARG;
+    locales = (long long *)calloc(cubetas, sizeof(long long));
+    if (locales == NULL)
+        return MPI_ERR_NO_MEM;
+
+    escala = (max > min) ? (double)cubetas / ((double)max - (double)min) : 0.0;
+    for (i = 0; i < n; i++)
+    {
+        c = (int)(((double)datos[i] - (double)min) * escala);
+        if (c < 0)
+            c = 0;
+        else if (c >= cubetas)
+            c = cubetas - 1;
+        locales[c]++;
+    }
+
+    rc = MPI_Reduce(locales, cuentas, cubetas, MPI_LONG_LONG, MPI_SUM, raiz, comm);
+    free(locales);
+    return rc;
+}
@@ -0,0 +1,69 @@
+/*
+ ============================================================================
+ Name        : cuantiles_mpi.h
+ Description : Estadisticas de orden sobre muestras distribuidas, sin reunir
+               los datos en un proceso:
+                 - cuantiles exactos por seleccion paralela (radix select
+                   sobre las claves de los float o double, una reduccion
+                   por pasada)
+                 - cuantiles aproximados con un boceto combinable (muestra
+                   uniforme de tamano fijo, bottom-k) reducido con MPI_Op
+                 - histograma por cubetas con MPI_Reduce
+               Cuantil p = elemento de indice floor(p*(N-1)) del orden global.
+ ============================================================================
+*/
+
+#ifndef CUANTILES_MPI_H
+#define CUANTILES_MPI_H
+
+#include <stdint.h>
+#include "mpi.h"
+
+#define CUANTILES_MAX 64     /* cuantiles por llamada a cuantiles_exactos */
+#define BOCETO_K 2048        /* tamano de la muestra del boceto            */
+
+/*
+ * Cuantiles exactos de la union de 'datos' de todos los procesos de 'comm'.
+ * Hace 4 pasadas sobre los datos locales y 4 MPI_Allreduce de nq*256 cuentas,
+ * sin importar N. Todos los procesos reciben 'resultado'. Los datos no deben
+ * contener NaN.
+ */
+int cuantiles_exactos(const float *datos, long long n, const double *p, int nq,
+                      float *resultado, MPI_Comm comm);
+
+/* Igual para datos double: 8 pasadas y 8 MPI_Allreduce sobre claves de 64 bits */
+int cuantiles_exactos_double(const double *datos, long long n, const double *p, int nq,
+                             double *resultado, MPI_Comm comm);
+
+/* Muestra uniforme combinable: se guardan los BOCETO_K elementos de menor prioridad */
+typedef struct
+{
+    int n;
+    uint32_t prioridad[BOCETO_K]; /* ordenadas de menor a mayor */
+    float valor[BOCETO_K];
+} boceto_t;
+
+/*
+ * Construye el boceto local. La prioridad de cada elemento depende solo de su
+ * indice global (inicio_global + i), asi el boceto combinado es el mismo para
+ * cualquier numero de procesos.
+ */
+void boceto_construir(boceto_t *b, const float *datos, long long n, long long inicio_global);
+
+/* a <- a U b (ambos deben venir de boceto_construir o de otra combinacion) */
+void boceto_combinar(boceto_t *a, const boceto_t *b);
+
+/* Cuantil aproximado a partir de la muestra; error de rango ~ 1/sqrt(BOCETO_K) */
+float boceto_cuantil(const boceto_t *b, double p);
+
+void boceto_mpi_crear(MPI_Datatype *tipo, MPI_Op *op);
+void boceto_mpi_liberar(MPI_Datatype *tipo, MPI_Op *op);
+
+/*
+ * Histograma de 'cubetas' cubetas iguales en [min, max]; los valores fuera del
+ * rango van a la primera o ultima cubeta. Las cuentas se suman en 'raiz'.
+ */
+int histograma_mpi(const float *datos, long long n, float min, float max, int cubetas,
+                   long long *cuentas, int raiz, MPI_Comm comm);
+
+#endif /* CUANTILES_MPI_H */
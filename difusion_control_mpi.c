@@ -0,0 +1,130 @@
+/*
+ ============================================================================
+ Name        : difusion_control_mpi.c
+ Compile     : mpicc -g -O2 difusion_control_mpi.c control_mpi.c -o difusion_control_mpi.exe
+ Run         : mpiexec  -n 64 ./difusion_control_mpi [repeticiones] [bytes]
+ Description : Tiempo de una ronda de control (raiz -> todos y respuestas
+               de todos -> raiz) con el esquema plano de
+               comunicacion_basica_solucion.c (envios uno tras otro y
+               recepciones en orden de rango) y con el arbol por nodos de
+               control_mpi.c. Se ejecuta con distintos -n para ver como
+               crece cada esquema con el numero de procesos.
+ ============================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mpi.h"
+#include "control_mpi.h"
+#include "tiempo_mpi.h"
+
+#define REPETICIONES 100
+#define BYTES_MENSAJE 20
+#define ETIQUETA_MENSAJE 1
+#define ETIQUETA_RESPUESTA 99
+
+static void contar_respuesta(int origen, const void *datos, void *contexto)
+{
+    int valor;
+
+    memcpy(&valor, datos, sizeof(int));
+    if (valor == origen)
+        (*(int *)contexto)++;
+}
+
+int main(int argc, char **argv)
+{
+    int rango, tamano, repeticiones, bytes, i, p, respuesta, recibidas, correctas_plano = 0,
+        correctas_arbol = 0, errores = 0, errores_totales;
+    double t1, t_plano, t_arbol, t_inicio;
+    char *mensaje;
+    control_t control;
+    MPI_Status estado;
+
+    MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
+    MPI_Comm_rank(MPI_COMM_WORLD, &rango);
+    MPI_Comm_size(MPI_COMM_WORLD, &tamano);
+
+    repeticiones = (argc > 1) ? atoi(argv[1]) : REPETICIONES;
+    bytes = (argc > 2) ? atoi(argv[2]) : BYTES_MENSAJE;
+    if (repeticiones < 1)
+        repeticiones = REPETICIONES;
+    if (bytes < 1)
+        bytes = BYTES_MENSAJE;
+    mensaje = (char *)malloc(bytes);
+
+    control_crear(MPI_COMM_WORLD, &control);
+
+    /******************************
+     * Esquema plano: O(P) envios seguidos y respuestas en orden de rango
+     ******************************/
+    MPI_Barrier(MPI_COMM_WORLD);
+    t1 = MPI_Wtime();
+    for (i = 0; i < repeticiones; i++)
+    {
+        if (rango == 0)
+        {
+            memset(mensaje, 'a' + i % 26, bytes);
+            for (p = 1; p < tamano; p++)
+                MPI_Send(mensaje, bytes, MPI_CHAR, p, ETIQUETA_MENSAJE, MPI_COMM_WORLD);
+            for (p = 1; p < tamano; p++)
+            {
+                MPI_Recv(&respuesta, 1, MPI_INT, p, ETIQUETA_RESPUESTA, MPI_COMM_WORLD, &estado);
+                if (respuesta == p)
+                    correctas_plano++;
+            }
+        }
+        else
+        {
+            MPI_Recv(mensaje, bytes, MPI_CHAR, 0, ETIQUETA_MENSAJE, MPI_COMM_WORLD, &estado);
+            if (mensaje[bytes - 1] != 'a' + i % 26)
+                errores++;
+            MPI_Send(&rango, 1, MPI_INT, 0, ETIQUETA_RESPUESTA, MPI_COMM_WORLD);
+        }
+    }
+    t_plano = (MPI_Wtime() - t1) / repeticiones;
+
+    /******************************
+     * Arbol por nodos + recoleccion en orden de llegada
+     ******************************/
+    MPI_Barrier(MPI_COMM_WORLD);
+    t1 = MPI_Wtime();
+    for (i = 0; i < repeticiones; i++)
+    {
+        if (rango == 0)
+            memset(mensaje, 'A' + i % 26, bytes);
+        control_difundir(&control, mensaje, bytes, MPI_CHAR);
+        if (mensaje[bytes - 1] != 'A' + i % 26)
+            errores++;
+        recibidas = 0;
+        control_recolectar(&control, &rango, sizeof(int), contar_respuesta, &recibidas);
+        correctas_arbol += recibidas;
+    }
+    t_arbol = (MPI_Wtime() - t1) / repeticiones;
+
+    MPI_Reduce(&errores, &errores_totales, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rango == 0)
+    {
+        int esperadas = repeticiones * (tamano - 1);
+
+        printf("\n******************** Ronda de control raiz <-> todos ********************\n");
+        printf("Procesos = %d, nodos = %d, bytes por mensaje = %d, repeticiones = %d\n",
+               tamano, control.num_nodos, bytes, repeticiones);
+        printf("%-28s %14s   %s\n", "esquema", "us por ronda", "verif.");
+        printf("%-28s %14.3f   %s\n", "plano (orden de rango)", t_plano * 1e6,
+               (correctas_plano == esperadas && errores_totales == 0) ? "OK" : "FALLA");
+        printf("%-28s %14.3f   %s\n", "arbol por nodos", t_arbol * 1e6,
+               (correctas_arbol == esperadas && errores_totales == 0) ? "OK" : "FALLA");
+        printf("Aceleracion = %.2f\n", t_arbol > 0 ? t_plano / t_arbol : 0.0);
+    }
+
+    control_liberar(&control);
+    free(mensaje);
+    reportar_tiempo_nucleo("difusion_control_mpi", (t_plano + t_arbol) * repeticiones, 0, MPI_COMM_WORLD);
+    reportar_tiempo_pared("difusion_control_mpi", t_inicio, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return 0;
+}
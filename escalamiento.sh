@@ -0,0 +1,213 @@
+#!/bin/bash
+# ============================================================================
+# Name        : escalamiento.sh
+# Run         : make escalamiento   (o ./escalamiento.sh despues de make)
+# Description : Estudio de escalamiento fuerte (N fijo) y debil (N por proceso
+#               fijo) de todos los programas. Cada programa imprime su tiempo
+#               de pared en una linea TIEMPO_PARED y, si tiene una region de
+#               calculo y comunicacion medida aparte, una linea TIEMPO_NUCLEO
+#               (tiempo_mpi.h). La aceleracion y la eficiencia se calculan con
+#               el tiempo de nucleo (o el de pared si no hay); el CSV guarda
+#               ambos y el tiempo por repeticion (us por intercambio del halo).
+#
+# Variables de entorno (valores por defecto entre parentesis):
+#   PROCESOS            lista de -n a barrer ("1 2 4 8")
+#   PROGRAMAS           subconjunto de programas (todos)
+#   REPETICIONES        ejecuciones por punto, se toma el minimo (1)
+#   MPIEXEC             lanzador (mpiexec)
+#   MPIEXEC_OPCIONES    opciones extra; con Open MPI se agrega --oversubscribe
+#   EFICIENCIA_MINIMA   si > 0, termina con error si alguna eficiencia es menor (0)
+#   SALIDA              directorio de resultados (_escalamiento)
+#   PI_N, PI_N_POR_PROC             intervalos de aproximacion_pi (2e8, 5e7)
+#   MC_N, MC_N_POR_PROC             puntos de minimos_cuadrados (400000, 100000)
+#   MC_MODO                         ols, huber o tukey; con IRLS se listan las
+#                                   iteraciones y el tiempo por iteracion (ols)
+#                                   (los residuales punto a punto no se listan:
+#                                   MINIMOS_LISTAR_RESIDUALES=0)
+#   MUESTRAS, MUESTRAS_POR_PROC     comunicacion_colectiva y estadisticas_orden (8e6, 2e6)
+#   HALO_CELDAS                     celdas por dimension y proceso del halo 2-D (256)
+#   HALO_BACKEND                    backend del halo medido, o todos (isend_irecv)
+# ============================================================================
+
+set -u
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+PROCESOS=${PROCESOS:-"1 2 4 8"}
+PROGRAMAS=${PROGRAMAS:-"aproximacion_pi_solucion minimos_cuadrados_solucion comunicacion_colectiva_solucion estadisticas_orden_mpi intercambio_halo_mpi difusion_control_mpi comunicacion_basica_solucion ancho_banda_mpi latencia_mpi bloqueo_mutuo_corregido"}
+REPETICIONES=${REPETICIONES:-1}
+MPIEXEC=${MPIEXEC:-mpiexec}
+EFICIENCIA_MINIMA=${EFICIENCIA_MINIMA:-0}
+SALIDA=${SALIDA:-_escalamiento}
+PI_N=${PI_N:-200000000}
+PI_N_POR_PROC=${PI_N_POR_PROC:-50000000}
+MC_N=${MC_N:-400000}
+MC_N_POR_PROC=${MC_N_POR_PROC:-100000}
+MC_MODO=${MC_MODO:-ols}
+MUESTRAS=${MUESTRAS:-8000000}
+MUESTRAS_POR_PROC=${MUESTRAS_POR_PROC:-2000000}
+HALO_CELDAS=${HALO_CELDAS:-256}
+HALO_BACKEND=${HALO_BACKEND:-isend_irecv}
+
+if [ -z "${MPIEXEC_OPCIONES+x}" ]; then
+    MPIEXEC_OPCIONES=""
+    if $MPIEXEC --version 2>&1 | grep -qi "open mpi\|openrte"; then
+        MPIEXEC_OPCIONES="--oversubscribe"
+    fi
+fi
+
+mkdir -p "$SALIDA/logs" "$SALIDA/trabajo"
+SALIDA=$(cd "$SALIDA" && pwd)
+CSV="$SALIDA/resultados.csv"
+echo "programa,modo,procesos,segundos_nucleo,segundos_pared,us_por_repeticion" > "$CSV"
+
+# ---------------------------------------------------------------------------
+# Modos que admite cada programa:
+#   fuerte  N total fijo       debil  N por proceso fijo
+#   fijo    no tiene un tamano de problema por proceso (o solo corre con -n 2):
+#           se reporta el tiempo, sin aceleracion, eficiencia ni umbral.
+#           difusion_control y comunicacion_basica no comunican con -n 1, asi
+#           que ese punto no sirve de base para una eficiencia.
+# ---------------------------------------------------------------------------
+modos_de() {
+    case "$1" in
+        aproximacion_pi_solucion | minimos_cuadrados_solucion | \
+        comunicacion_colectiva_solucion | estadisticas_orden_mpi) echo "fuerte debil" ;;
+        intercambio_halo_mpi) echo "debil" ;;
+        difusion_control_mpi | comunicacion_basica_solucion | ancho_banda_mpi | \
+        latencia_mpi | bloqueo_mutuo_corregido) echo "fijo" ;;
+        *) echo "" ;;
+    esac
+}
+
+procesos_validos() {
+    local programa=$1 p=$2
+    case "$programa" in
+        ancho_banda_mpi) [ $((p % 2)) -eq 0 ] ;;
+        latencia_mpi | bloqueo_mutuo_corregido) [ "$p" -eq 2 ] ;;
+        *) [ "$p" -ge 1 ] ;;
+    esac
+}
+
+# Puntos x,y alrededor de y = 6.9 - 2.8 x para minimos_cuadrados
+generar_datos_xy() {
+    awk -v n="$1" 'BEGIN {
+        srand(12345);
+        print n;
+        for (i = 0; i < n; i++) {
+            x = 10.0 * i / n;
+            printf "%.6f %.6f\n", x, 6.9 - 2.8 * x + (rand() - 0.5);
+        }
+    }' > datos_xy.txt
+}
+
+# Valor de 'campo=' en la primera linea 'etiqueta' del log, o "-"
+campo_de() {
+    local v
+    v=$(grep -m1 "^$2 " "$1" | sed -n "s/.* $3=\([^ ]*\).*/\1/p")
+    echo "${v:--}"
+}
+
+# Ejecuta un caso y devuelve por stdout "nucleo pared us_por_repeticion"
+# (vacio si fallo; nucleo = pared si el programa no lo reporta)
+ejecutar() {
+    local programa=$1 modo=$2 p=$3 n log
+    log="$SALIDA/logs/${programa}_${modo}_${p}.log"
+    mkdir -p "$SALIDA/trabajo/$programa"
+    cd "$SALIDA/trabajo/$programa" || return
+    local lanzar="$MPIEXEC $MPIEXEC_OPCIONES -n $p $DIR/$programa.exe"
+
+    case "$programa" in
+        aproximacion_pi_solucion)
+            n=$PI_N; [ "$modo" = debil ] && n=$((PI_N_POR_PROC * p))
+            rm -f aproximacion_pi.pesos
+            printf "%s\n0\n" "$n" | $lanzar > "$log" 2>&1 ;;
+        minimos_cuadrados_solucion)
+            n=$MC_N; [ "$modo" = debil ] && n=$((MC_N_POR_PROC * p))
+            rm -f minimos_cuadrados.pesos
+            generar_datos_xy "$n"
+            MINIMOS_LISTAR_RESIDUALES=0 $lanzar "$MC_MODO" > "$log" 2>&1 ;;
+        comunicacion_colectiva_solucion)
+            n=$MUESTRAS; [ "$modo" = debil ] && n=$((MUESTRAS_POR_PROC * p))
+            echo 123456 | $lanzar "$n" > "$log" 2>&1 ;;
+        estadisticas_orden_mpi)
+            n=$MUESTRAS; [ "$modo" = debil ] && n=$((MUESTRAS_POR_PROC * p))
+            $lanzar "$n" > "$log" 2>&1 ;;
+        intercambio_halo_mpi)
+            $lanzar 2 "$HALO_CELDAS" 100 "$HALO_BACKEND" > "$log" 2>&1 ;;
+        *)
+            $lanzar > "$log" 2>&1 ;;
+    esac
+    cd "$DIR" || return
+    local pared nucleo
+    pared=$(campo_de "$log" TIEMPO_PARED segundos)
+    [ "$pared" = - ] && return
+    nucleo=$(campo_de "$log" TIEMPO_NUCLEO segundos)
+    [ "$nucleo" = - ] && nucleo=$pared
+    echo "$nucleo $pared $(campo_de "$log" TIEMPO_NUCLEO us_por_repeticion)"
+}
+
+fallos=0
+regresiones=0
+
+for programa in $PROGRAMAS; do
+    if [ ! -x "$DIR/$programa.exe" ]; then
+        echo "!! falta $programa.exe (ejecute make)" >&2
+        fallos=$((fallos + 1))
+        continue
+    fi
+    for modo in $(modos_de "$programa"); do
+        echo
+        echo "=== $programa ($modo) ==="
+        printf "%8s %12s %12s %12s %12s %12s\n" "procesos" "nucleo (s)" "pared (s)" "aceleracion" "eficiencia" "us/repet."
+        base_p=""
+        base_t=""
+        for p in $PROCESOS; do
+            procesos_validos "$programa" "$p" || continue
+            mejor=""
+            mejor_fila=""
+            for ((k = 0; k < REPETICIONES; k++)); do
+                fila=$(ejecutar "$programa" "$modo" "$p")
+                t=${fila%% *}
+                if [ -n "$fila" ] && { [ -z "$mejor" ] || awk -v a="$t" -v b="$mejor" 'BEGIN { exit !(a < b) }'; }; then
+                    mejor=$t
+                    mejor_fila=$fila
+                fi
+            done
+            if [ -z "$mejor" ]; then
+                printf "%8d %12s   (fallo, ver %s)\n" "$p" "-" "logs/${programa}_${modo}_${p}.log"
+                fallos=$((fallos + 1))
+                continue
+            fi
+            read -r _ pared us <<< "$mejor_fila"
+            echo "$programa,$modo,$p,$mejor,$pared,$([ "$us" = - ] || echo "$us")" >> "$CSV"
+            if [ -z "$base_t" ]; then
+                base_p=$p
+                base_t=$mejor
+            fi
+
+            # fuerte: S = T(p0) p0 / T(p), E = S / p     debil: E = T(p0) / T(p), S = E p / p0
+            linea=$(awk -v modo="$modo" -v p0="$base_p" -v t0="$base_t" -v p="$p" -v t="$mejor" \
+                        -v pared="$pared" -v us="$us" -v minima="$EFICIENCIA_MINIMA" 'BEGIN {
+                if (modo == "fijo") { printf "%8d %12.6f %12.6f %12s %12s %12s 0", p, t, pared, "-", "-", us; exit }
+                if (modo == "fuerte") { s = t0 * p0 / t; e = s / p }
+                else { e = t0 / t; s = e * p / p0 }
+                bajo = (minima > 0 && p != p0 && e < minima) ? 1 : 0;
+                printf "%8d %12.6f %12.6f %12.2f %11.1f%% %12s %d", p, t, pared, s, 100.0 * e, us, bajo
+            }')
+            echo "${linea% *}$([ "${linea##* }" = 1 ] && echo "   << por debajo de $EFICIENCIA_MINIMA")"
+            [ "${linea##* }" = 1 ] && regresiones=$((regresiones + 1))
+            grep -m1 '^IRLS' "$SALIDA/logs/${programa}_${modo}_${p}.log" | sed 's/^/         /'
+        done
+    done
+done
+
+echo
+echo "Resultados: $CSV"
+if [ "$fallos" -gt 0 ]; then
+    echo "Ejecuciones fallidas: $fallos" >&2
+fi
+if [ "$regresiones" -gt 0 ]; then
+    echo "Puntos con eficiencia menor que $EFICIENCIA_MINIMA: $regresiones" >&2
+    exit 1
+fi
+[ "$fallos" -eq 0 ]
@@ -0,0 +1,123 @@
+/*
+ ============================================================================
+ Name        : estadisticas_mpi.c
+ Description : Implementacion de las estadisticas en flujo (ver estadisticas_mpi.h).
+ ============================================================================
+*/
+
+#include <stddef.h>
+#include <float.h>
+#include <math.h>
+#include "estadisticas_mpi.h"
+
+void estadisticas_iniciar(estadisticas_t *e)
+{
+    e->n = 0;
+    e->media = 0.0;
+    e->m2 = 0.0;
+    e->min = DBL_MAX;
+    e->max = -DBL_MAX;
+}
+
+void estadisticas_agregar_bloque(estadisticas_t *e, const float *x, long long n)
+{
+    estadisticas_t bloque;
+    double suma = 0.0, m2 = 0.0, min = DBL_MAX, max = -DBL_MAX, media, d;
+    long long i;
+
+    if (n <= 0)
+        return;
+
+    for (i = 0; i < n; i++)
+    {
+        suma += x[i];
+        if (x[i] < min)
+            min = x[i];
+        if (x[i] > max)
+            max = x[i];
+    }
+    media = suma / (double)n;
+    for (i = 0; i < n; i++)
+    {
+        d = x[i] - media;
+        m2 += d * d;
+    }
+
+    bloque.n = n;
+    bloque.media = media;
+    bloque.m2 = m2;
+    bloque.min = min;
+    bloque.max = max;
+    estadisticas_combinar(e, &bloque);
+}
+
+/* ---------------------------------------------------------------
+ * Combinacion de Chan et al.:
+ *   delta = media_b - media_a
+ *   n     = n_a + n_b
+ *   media = media_a + delta * n_b / n
+ *   M2    = M2_a + M2_b + delta^2 * n_a * n_b / n
+ * --------------------------------------------------------------- */
+void estadisticas_combinar(estadisticas_t *a, const estadisticas_t *b)
+{
+    double delta, n;
+
+    if (b->n == 0)
+        return;
+    if (a->n == 0)
+    {
+        *a = *b;
+        return;
+    }
+
+    n = (double)(a->n + b->n);
+    delta = b->media - a->media;
+    a->media += delta * (double)b->n / n;
+    a->m2 += b->m2 + delta * delta * (double)a->n * (double)b->n / n;
+    a->n += b->n;
+    if (b->min < a->min)
+        a->min = b->min;
+    if (b->max > a->max)
+        a->max = b->max;
+}
+
+double estadisticas_varianza(const estadisticas_t *e)
+{
+    return (e->n > 0) ? e->m2 / (double)e->n : 0.0;
+}
+
+double estadisticas_desv_estandar(const estadisticas_t *e)
+{
+    return sqrt(estadisticas_varianza(e));
+}
+
+static void combinar_mpi(void *entrada, void *entrada_salida, int *longitud, MPI_Datatype *tipo)
+{
+    const estadisticas_t *in = (const estadisticas_t *)entrada;
+    estadisticas_t *inout = (estadisticas_t *)entrada_salida;
+    int i;
+
+    (void)tipo;
+    for (i = 0; i < *longitud; i++)
+        estadisticas_combinar(&inout[i], &in[i]);
+}
+
+void estadisticas_mpi_crear(MPI_Datatype *tipo, MPI_Op *op)
+{
+    int longitudes[2] = {1, 4};
+    MPI_Aint desplazamientos[2] = {offsetof(estadisticas_t, n), offsetof(estadisticas_t, media)};
+    MPI_Datatype tipos[2] = {MPI_LONG_LONG, MPI_DOUBLE}, tmp;
+
+    MPI_Type_create_struct(2, longitudes, desplazamientos, tipos, &tmp);
+    MPI_Type_create_resized(tmp, 0, sizeof(estadisticas_t), tipo);
+    MPI_Type_free(&tmp);
+    MPI_Type_commit(tipo);
+
+    MPI_Op_create(combinar_mpi, 1, op);
+}
+
+void estadisticas_mpi_liberar(MPI_Datatype *tipo, MPI_Op *op)
+{
+    MPI_Op_free(op);
+    MPI_Type_free(tipo);
+}
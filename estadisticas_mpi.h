@@ -0,0 +1,41 @@
+/*
+ ============================================================================
+ Name        : estadisticas_mpi.h
+ Description : Estadisticas parciales en flujo (cuenta, media, M2, min, max)
+               que se combinan con el algoritmo paralelo de Welford/Chan.
+               Incluye el tipo derivado y la operacion MPI_Op definida por
+               el usuario para reducirlas con MPI_Reduce/MPI_Allreduce en
+               O(1) bytes por proceso, sin importar cuantas muestras haya.
+ ============================================================================
+*/
+
+#ifndef ESTADISTICAS_MPI_H
+#define ESTADISTICAS_MPI_H
+
+#include "mpi.h"
+
+typedef struct
+{
+    long long n;  /* numero de muestras                          */
+    double media; /* media acumulada                             */
+    double m2;    /* suma de cuadrados de desviaciones a la media */
+    double min;
+    double max;
+} estadisticas_t;
+
+void estadisticas_iniciar(estadisticas_t *e);
+
+/* Agrega un bloque: dos pasadas sobre el bloque (que esta en cache) y una combinacion */
+void estadisticas_agregar_bloque(estadisticas_t *e, const float *x, long long n);
+
+/* a <- a U b */
+void estadisticas_combinar(estadisticas_t *a, const estadisticas_t *b);
+
+double estadisticas_varianza(const estadisticas_t *e);     /* poblacional: M2 / n */
+double estadisticas_desv_estandar(const estadisticas_t *e); /* sqrt(M2 / n)        */
+
+/* Crea (y confirma) el tipo MPI de estadisticas_t y la operacion conmutativa de combinacion */
+void estadisticas_mpi_crear(MPI_Datatype *tipo, MPI_Op *op);
+void estadisticas_mpi_liberar(MPI_Datatype *tipo, MPI_Op *op);
+
+#endif /* ESTADISTICAS_MPI_H */
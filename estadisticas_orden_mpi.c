@@ -0,0 +1,199 @@
+/*
+ ============================================================================
+ Name        : estadisticas_orden_mpi.c
+ Compile     : mpicc -g -O3 estadisticas_orden_mpi.c cuantiles_mpi.c estadisticas_mpi.c aleatorio_mpi.c particion_mpi.c -o estadisticas_orden_mpi.exe -lm
+ Run         : mpiexec  -n 8 ./estadisticas_orden_mpi [muestras_totales] [semilla]
+ Description : Mediana, percentiles e histograma de una muestra distribuida.
+               Compara la seleccion paralela exacta y el boceto aproximado
+               con la linea base de reunir todo en el proceso 0 y ordenar.
+               Las muestras son exponenciales de media 10 (mediana teorica
+               10 ln 2 = 6.931).
+ ============================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include "mpi.h"
+#include "aleatorio_mpi.h"
+#include "estadisticas_mpi.h"
+#include "cuantiles_mpi.h"
+#include "particion_mpi.h"
+#include "tiempo_mpi.h"
+
+#define MUESTRAS_TOTALES 4000000LL
+#define SEMILLA 123456
+#define NUM_CUANTILES 5
+#define CUBETAS 20
+#define MEDIA_EXPONENCIAL 10.0f
+
+static int comparar_float(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv)
+{
+    int rango, tamano, j, c;
+    long long muestras_totales, mis_muestras, inicio, i;
+    unsigned int semilla;
+    float *datos, exactos[NUM_CUANTILES], base[NUM_CUANTILES], aproximados[NUM_CUANTILES];
+    double p[NUM_CUANTILES] = {0.01, 0.25, 0.5, 0.9, 0.99};
+    double t1, t_local[3], t_max[3] = {0.0, 0.0, 0.0}, t_base = 0.0, t_inicio;
+    long long cuentas[CUBETAS];
+    aleatorio_t generador;
+    estadisticas_t parciales, globales;
+    boceto_t *boceto_local, *boceto_global;
+    MPI_Datatype tipo_estadisticas, tipo_boceto;
+    MPI_Op op_estadisticas, op_boceto;
+    particion_t particion;
+
+    MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
+    MPI_Comm_rank(MPI_COMM_WORLD, &rango);
+    MPI_Comm_size(MPI_COMM_WORLD, &tamano);
+
+    muestras_totales = (argc > 1) ? atoll(argv[1]) : MUESTRAS_TOTALES;
+    semilla = (argc > 2) ? (unsigned int)atol(argv[2]) : SEMILLA;
+    if (muestras_totales < 1)
+        muestras_totales = MUESTRAS_TOTALES;
+
+    /* reparto q/r del flujo global de muestras (pesos iguales) */
+    particion_crear(&particion, MPI_COMM_WORLD, NULL);
+    particion_repartir(&particion, muestras_totales);
+    mis_muestras = particion.cantidades[rango];
+    inicio = particion.inicios[rango];
+    particion_liberar(&particion);
+
+    datos = (float *)malloc((mis_muestras > 0 ? mis_muestras : 1) * sizeof(float));
+    aleatorio_iniciar(&generador, semilla, 1);
+    aleatorio_saltar(&generador, inicio);
+    aleatorio_llenar_uniforme(&generador, datos, mis_muestras, 1.0f);
+    for (i = 0; i < mis_muestras; i++)
+        datos[i] = -MEDIA_EXPONENCIAL * logf(1.0f - datos[i]);
+
+    /******************************
+     * Linea base: reunir en el proceso 0 y ordenar
+     ******************************/
+    if (muestras_totales <= INT_MAX)
+    {
+        int cuenta = (int)mis_muestras, *cuentas_rec = NULL, *desplazamientos = NULL;
+        float *todos = NULL;
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        t1 = MPI_Wtime();
+        if (rango == 0)
+        {
+            cuentas_rec = (int *)malloc(tamano * sizeof(int));
+            desplazamientos = (int *)malloc(tamano * sizeof(int));
+            todos = (float *)malloc(muestras_totales * sizeof(float));
+        }
+        MPI_Gather(&cuenta, 1, MPI_INT, cuentas_rec, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (rango == 0)
+        {
+            desplazamientos[0] = 0;
+            for (j = 1; j < tamano; j++)
+                desplazamientos[j] = desplazamientos[j - 1] + cuentas_rec[j - 1];
+        }
+        MPI_Gatherv(datos, cuenta, MPI_FLOAT, todos, cuentas_rec, desplazamientos, MPI_FLOAT, 0, MPI_COMM_WORLD);
+        if (rango == 0)
+        {
+            qsort(todos, muestras_totales, sizeof(float), comparar_float);
+            for (j = 0; j < NUM_CUANTILES; j++)
+                base[j] = todos[(long long)floor(p[j] * (double)(muestras_totales - 1))];
+            t_base = MPI_Wtime() - t1;
+            free(todos);
+            free(cuentas_rec);
+            free(desplazamientos);
+        }
+    }
+
+    /******************************
+     * Cuantiles exactos por seleccion paralela
+     ******************************/
+    MPI_Barrier(MPI_COMM_WORLD);
+    t1 = MPI_Wtime();
+    cuantiles_exactos(datos, mis_muestras, p, NUM_CUANTILES, exactos, MPI_COMM_WORLD);
+    t_local[0] = MPI_Wtime() - t1;
+
+    /******************************
+     * Cuantiles aproximados con el boceto combinable
+     ******************************/
+    boceto_local = (boceto_t *)malloc(sizeof(boceto_t));
+    boceto_global = (boceto_t *)malloc(sizeof(boceto_t));
+    boceto_mpi_crear(&tipo_boceto, &op_boceto);
+    MPI_Barrier(MPI_COMM_WORLD);
+    t1 = MPI_Wtime();
+    boceto_construir(boceto_local, datos, mis_muestras, inicio);
+    MPI_Reduce(boceto_local, boceto_global, 1, tipo_boceto, op_boceto, 0, MPI_COMM_WORLD);
+    if (rango == 0)
+        for (j = 0; j < NUM_CUANTILES; j++)
+            aproximados[j] = boceto_cuantil(boceto_global, p[j]);
+    t_local[1] = MPI_Wtime() - t1;
+    boceto_mpi_liberar(&tipo_boceto, &op_boceto);
+
+    /******************************
+     * Histograma: rango global con las estadisticas en flujo + MPI_Reduce de cubetas
+     ******************************/
+    estadisticas_mpi_crear(&tipo_estadisticas, &op_estadisticas);
+    MPI_Barrier(MPI_COMM_WORLD);
+    t1 = MPI_Wtime();
+    estadisticas_iniciar(&parciales);
+    estadisticas_agregar_bloque(&parciales, datos, mis_muestras);
+    MPI_Allreduce(&parciales, &globales, 1, tipo_estadisticas, op_estadisticas, MPI_COMM_WORLD);
+    histograma_mpi(datos, mis_muestras, (float)globales.min, (float)globales.max, CUBETAS,
+                   cuentas, 0, MPI_COMM_WORLD);
+    t_local[2] = MPI_Wtime() - t1;
+    estadisticas_mpi_liberar(&tipo_estadisticas, &op_estadisticas);
+
+    MPI_Reduce(t_local, t_max, 3, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if (rango == 0)
+    {
+        int coinciden = 1;
+        double ancho = (globales.max - globales.min) / CUBETAS;
+
+        printf("\nEstadisticas de orden: %lld muestras, %d procesos\n\n", muestras_totales, tamano);
+        printf("   p        exacto    gather+sort    aproximado\n");
+        printf("--------------------------------------------------\n");
+        for (j = 0; j < NUM_CUANTILES; j++)
+        {
+            if (muestras_totales <= INT_MAX)
+            {
+                printf("  %5.2f  %12.6f  %12.6f  %12.6f\n", p[j], exactos[j], base[j], aproximados[j]);
+                if (exactos[j] != base[j])
+                    coinciden = 0;
+            }
+            else
+                printf("  %5.2f  %12.6f  %12s  %12.6f\n", p[j], exactos[j], "-", aproximados[j]);
+        }
+        printf("--------------------------------------------------\n");
+        if (muestras_totales <= INT_MAX)
+            printf("Exactos vs gather+sort: %s\n", coinciden ? "OK" : "DIFIEREN");
+        printf("Mediana teorica = %.6f\n\n", MEDIA_EXPONENCIAL * log(2.0));
+
+        printf("Tiempos (max entre procesos):\n");
+        if (muestras_totales <= INT_MAX)
+            printf("  gather + sort      %10.6f s\n", t_base);
+        printf("  seleccion exacta   %10.6f s\n", t_max[0]);
+        printf("  boceto aproximado  %10.6f s\n", t_max[1]);
+        printf("  histograma         %10.6f s\n\n", t_max[2]);
+
+        printf("Histograma (media = %.3f, desv.est = %.3f):\n", globales.media,
+               estadisticas_desv_estandar(&globales));
+        for (c = 0; c < CUBETAS; c++)
+            printf("  [%9.3f, %9.3f)  %12lld\n", globales.min + c * ancho, globales.min + (c + 1) * ancho,
+                   cuentas[c]);
+    }
+
+    free(boceto_local);
+    free(boceto_global);
+    free(datos);
+    /* nucleo: los tres metodos paralelos, sin la linea base gather+sort */
+    reportar_tiempo_nucleo("estadisticas_orden_mpi", t_local[0] + t_local[1] + t_local[2], 0, MPI_COMM_WORLD);
+    reportar_tiempo_pared("estadisticas_orden_mpi", t_inicio, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,230 @@
+/*
+ ============================================================================
+ Name        : halo_mpi.c
+ Description : Implementacion del intercambio de halos (ver halo_mpi.h).
+               Generaliza el intercambio de 2 procesos de
+               bloqueo_mutuo_corregido.c a N procesos en una malla cartesiana.
+ ============================================================================
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "halo_mpi.h"
+
+/* ---------------------------------------------------------------
+ * Convencion de indices para las caras de la dimension d:
+ *   lado 0 = vecino inferior (coordenada - 1)
+ *   lado 1 = vecino superior (coordenada + 1)
+ * Es el mismo orden que usa MPI_Neighbor_alltoallw para topologias
+ * cartesianas: bloque 2*d -> inferior, bloque 2*d+1 -> superior.
+ *
+ * Etiquetas: lo que viaja hacia el vecino inferior usa 2*d y lo que
+ * viaja hacia el superior 2*d+1, asi el mensaje que sale por un lado
+ * siempre empareja con el recibo del lado opuesto del vecino (incluso
+ * cuando la dimension es periodica con un solo proceso).
+ * --------------------------------------------------------------- */
+
+static int crear_cara(const halo_t *halo, int d, int inicio_d, MPI_Datatype *tipo)
+{
+    int subtam[HALO_MAX_DIMS], inicios[HALO_MAX_DIMS], k, rc;
+
+    for (k = 0; k < halo->ndims; k++)
+    {
+        subtam[k] = (k == d) ? halo->ancho : halo->local[k];
+        inicios[k] = (k == d) ? inicio_d : halo->ancho;
+    }
+    rc = MPI_Type_create_subarray(halo->ndims, (int *)halo->total, subtam, inicios,
+                                  MPI_ORDER_C, MPI_FLOAT, tipo);
+    if (rc != MPI_SUCCESS)
+        return rc;
+    return MPI_Type_commit(tipo);
+}
+
+static void publicar_recibos(halo_t *halo, MPI_Request *reqs, int persistente)
+{
+    int d, n = 0;
+
+    for (d = 0; d < halo->ndims; d++)
+    {
+        if (persistente)
+        {
+            MPI_Recv_init(halo->campo, 1, halo->cara_recibo[d][0], halo->vecinos[d][0],
+                          2 * d + 1, halo->comm_cart, &reqs[n++]);
+            MPI_Recv_init(halo->campo, 1, halo->cara_recibo[d][1], halo->vecinos[d][1],
+                          2 * d, halo->comm_cart, &reqs[n++]);
+        }
+        else
+        {
+            MPI_Irecv(halo->campo, 1, halo->cara_recibo[d][0], halo->vecinos[d][0],
+                      2 * d + 1, halo->comm_cart, &reqs[n++]);
+            MPI_Irecv(halo->campo, 1, halo->cara_recibo[d][1], halo->vecinos[d][1],
+                      2 * d, halo->comm_cart, &reqs[n++]);
+        }
+    }
+    for (d = 0; d < halo->ndims; d++)
+    {
+        if (persistente)
+        {
+            MPI_Send_init(halo->campo, 1, halo->cara_envio[d][0], halo->vecinos[d][0],
+                          2 * d, halo->comm_cart, &reqs[n++]);
+            MPI_Send_init(halo->campo, 1, halo->cara_envio[d][1], halo->vecinos[d][1],
+                          2 * d + 1, halo->comm_cart, &reqs[n++]);
+        }
+        else
+        {
+            MPI_Isend(halo->campo, 1, halo->cara_envio[d][0], halo->vecinos[d][0],
+                      2 * d, halo->comm_cart, &reqs[n++]);
+            MPI_Isend(halo->campo, 1, halo->cara_envio[d][1], halo->vecinos[d][1],
+                      2 * d + 1, halo->comm_cart, &reqs[n++]);
+        }
+    }
+    halo->num_reqs = n;
+}
+
+int halo_crear(MPI_Comm comm, int ndims, const int *local, int ancho, int periodico,
+               halo_backend_t backend, float *campo, halo_t *halo)
+{
+    int size, periodos[HALO_MAX_DIMS], d, rango, rc;
+
+    if (ndims < 1 || ndims > HALO_MAX_DIMS || ancho < 1 || (int)backend < 0 || backend >= HALO_NUM_BACKENDS)
+        return MPI_ERR_ARG;
+
+    memset(halo, 0, sizeof(*halo));
+    halo->comm_cart = MPI_COMM_NULL;
+    for (d = 0; d < HALO_MAX_DIMS; d++)
+        halo->cara_envio[d][0] = halo->cara_envio[d][1] =
+            halo->cara_recibo[d][0] = halo->cara_recibo[d][1] = MPI_DATATYPE_NULL;
+    halo->ndims = ndims;
+    halo->ancho = ancho;
+    halo->backend = backend;
+    halo->campo = campo;
+
+    for (d = 0; d < ndims; d++)
+    {
+        if (local[d] < ancho)
+            return MPI_ERR_ARG;
+        halo->local[d] = local[d];
+        halo->total[d] = local[d] + 2 * ancho;
+        halo->dims[d] = 0;
+        periodos[d] = periodico;
+    }
+
+    /* ---------------------------------------------------------------
+     * Topologia cartesiana: MPI elige la descomposicion y puede
+     * reordenar rangos para aprovechar la red
+     * --------------------------------------------------------------- */
+    MPI_Comm_size(comm, &size);
+    MPI_Dims_create(size, ndims, halo->dims);
+    rc = MPI_Cart_create(comm, ndims, halo->dims, periodos, 1, &halo->comm_cart);
+    if (rc != MPI_SUCCESS)
+        return rc;
+    MPI_Comm_rank(halo->comm_cart, &rango);
+    MPI_Cart_coords(halo->comm_cart, rango, ndims, halo->coords);
+
+    for (d = 0; d < ndims; d++)
+    {
+        MPI_Cart_shift(halo->comm_cart, d, 1, &halo->vecinos[d][0], &halo->vecinos[d][1]);
+
+        /* primera y ultima capa interior se envian, las capas de halo se reciben */
+        if ((rc = crear_cara(halo, d, ancho, &halo->cara_envio[d][0])) != MPI_SUCCESS ||
+            (rc = crear_cara(halo, d, local[d], &halo->cara_envio[d][1])) != MPI_SUCCESS ||
+            (rc = crear_cara(halo, d, 0, &halo->cara_recibo[d][0])) != MPI_SUCCESS ||
+            (rc = crear_cara(halo, d, local[d] + ancho, &halo->cara_recibo[d][1])) != MPI_SUCCESS)
+            return rc;
+
+        /* argumentos de MPI_Neighbor_alltoallw: los subarreglos ya llevan el desplazamiento */
+        halo->cuentas[2 * d] = halo->cuentas[2 * d + 1] = 1;
+        halo->desplazamientos[2 * d] = halo->desplazamientos[2 * d + 1] = 0;
+        halo->tipos_envio[2 * d] = halo->cara_envio[d][0];
+        halo->tipos_envio[2 * d + 1] = halo->cara_envio[d][1];
+        halo->tipos_recibo[2 * d] = halo->cara_recibo[d][0];
+        halo->tipos_recibo[2 * d + 1] = halo->cara_recibo[d][1];
+    }
+
+    if (backend == HALO_PERSISTENTE)
+        publicar_recibos(halo, halo->reqs, 1);
+
+    return MPI_SUCCESS;
+}
+
+int halo_intercambiar(halo_t *halo)
+{
+    int d, rc = MPI_SUCCESS;
+
+    switch (halo->backend)
+    {
+    case HALO_ISEND_IRECV:
+        publicar_recibos(halo, halo->reqs, 0);
+        rc = MPI_Waitall(halo->num_reqs, halo->reqs, MPI_STATUSES_IGNORE);
+        break;
+
+    case HALO_SENDRECV:
+        /* en cada dimension: primero se desplaza todo hacia abajo, luego hacia arriba */
+        for (d = 0; d < halo->ndims && rc == MPI_SUCCESS; d++)
+        {
+            rc = MPI_Sendrecv(halo->campo, 1, halo->cara_envio[d][0], halo->vecinos[d][0], 2 * d,
+                              halo->campo, 1, halo->cara_recibo[d][1], halo->vecinos[d][1], 2 * d,
+                              halo->comm_cart, MPI_STATUS_IGNORE);
+            if (rc != MPI_SUCCESS)
+                break;
+            rc = MPI_Sendrecv(halo->campo, 1, halo->cara_envio[d][1], halo->vecinos[d][1], 2 * d + 1,
+                              halo->campo, 1, halo->cara_recibo[d][0], halo->vecinos[d][0], 2 * d + 1,
+                              halo->comm_cart, MPI_STATUS_IGNORE);
+        }
+        break;
+
+    case HALO_PERSISTENTE:
+        rc = MPI_Startall(halo->num_reqs, halo->reqs);
+        if (rc == MPI_SUCCESS)
+            rc = MPI_Waitall(halo->num_reqs, halo->reqs, MPI_STATUSES_IGNORE);
+        break;
+
+    case HALO_VECINOS_ALLTOALLW:
+        rc = MPI_Neighbor_alltoallw(halo->campo, halo->cuentas, halo->desplazamientos, halo->tipos_envio,
+                                    halo->campo, halo->cuentas, halo->desplazamientos, halo->tipos_recibo,
+                                    halo->comm_cart);
+        break;
+
+    default:
+        rc = MPI_ERR_ARG;
+    }
+    return rc;
+}
+
+void halo_liberar(halo_t *halo)
+{
+    int d, i;
+
+    if (halo->backend == HALO_PERSISTENTE)
+        for (i = 0; i < halo->num_reqs; i++)
+            MPI_Request_free(&halo->reqs[i]);
+
+    for (d = 0; d < halo->ndims; d++)
+        for (i = 0; i < 2; i++)
+        {
+            if (halo->cara_envio[d][i] != MPI_DATATYPE_NULL)
+                MPI_Type_free(&halo->cara_envio[d][i]);
+            if (halo->cara_recibo[d][i] != MPI_DATATYPE_NULL)
+                MPI_Type_free(&halo->cara_recibo[d][i]);
+        }
+
+    if (halo->comm_cart != MPI_COMM_NULL)
+        MPI_Comm_free(&halo->comm_cart);
+}
+
+const char *halo_nombre_backend(halo_backend_t backend)
+{
+    switch (backend)
+    {
+    case HALO_ISEND_IRECV:
+        return "isend_irecv";
+    case HALO_SENDRECV:
+        return "sendrecv";
+    case HALO_PERSISTENTE:
+        return "persistente";
+    case HALO_VECINOS_ALLTOALLW:
+        return "neighbor_alltoallw";
+    default:
+        return "desconocido";
+    }
+}
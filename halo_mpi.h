@@ -0,0 +1,72 @@
+/*
+ ============================================================================
+ Name        : halo_mpi.h
+ Description : Intercambio de halos para stencils 1-D/2-D/3-D sobre una
+               topologia cartesiana (MPI_Cart_create). Las caras se describen
+               con tipos derivados (MPI_Type_create_subarray), de modo que las
+               caras no contiguas se envian sin copias intermedias.
+ ============================================================================
+*/
+
+#ifndef HALO_MPI_H
+#define HALO_MPI_H
+
+#include "mpi.h"
+
+#define HALO_MAX_DIMS 3
+
+/* Forma de realizar el intercambio */
+typedef enum
+{
+    HALO_ISEND_IRECV = 0, /* Isend/Irecv de todas las caras + Waitall        */
+    HALO_SENDRECV,        /* un MPI_Sendrecv por direccion y dimension       */
+    HALO_PERSISTENTE,     /* MPI_Send_init/MPI_Recv_init + MPI_Startall      */
+    HALO_VECINOS_ALLTOALLW, /* MPI_Neighbor_alltoallw sobre el comunicador cartesiano */
+    HALO_NUM_BACKENDS
+} halo_backend_t;
+
+typedef struct
+{
+    MPI_Comm comm_cart;           /* comunicador con topologia cartesiana        */
+    int ndims;                    /* 1, 2 o 3                                    */
+    int dims[HALO_MAX_DIMS];      /* procesos por dimension                      */
+    int coords[HALO_MAX_DIMS];    /* coordenadas de este proceso                 */
+    int local[HALO_MAX_DIMS];     /* celdas interiores por dimension             */
+    int total[HALO_MAX_DIMS];     /* local + 2*ancho                             */
+    int ancho;                    /* ancho del halo en celdas                    */
+    int vecinos[HALO_MAX_DIMS][2]; /* [d][0] = inferior, [d][1] = superior      */
+    MPI_Datatype cara_envio[HALO_MAX_DIMS][2];
+    MPI_Datatype cara_recibo[HALO_MAX_DIMS][2];
+    halo_backend_t backend;
+    float *campo;                 /* arreglo local de total[0]*...*total[nd-1]   */
+
+    /* estado propio de cada backend */
+    int num_reqs;
+    MPI_Request reqs[4 * HALO_MAX_DIMS];
+    int cuentas[2 * HALO_MAX_DIMS];
+    MPI_Aint desplazamientos[2 * HALO_MAX_DIMS];
+    MPI_Datatype tipos_envio[2 * HALO_MAX_DIMS];
+    MPI_Datatype tipos_recibo[2 * HALO_MAX_DIMS];
+} halo_t;
+
+/*
+ * Crea la topologia cartesiana sobre 'comm' (dims elegidas con MPI_Dims_create),
+ * los tipos de las caras y el estado del backend. 'local' indica las celdas
+ * interiores por dimension (orden C: la ultima dimension es la contigua) y
+ * 'campo' debe tener espacio para (local[d] + 2*ancho) celdas por dimension.
+ * Solo se intercambian caras (sin esquinas), suficiente para stencils en cruz.
+ * Devuelve MPI_SUCCESS o un codigo de error MPI.
+ */
+int halo_crear(MPI_Comm comm, int ndims, const int *local, int ancho, int periodico,
+               halo_backend_t backend, float *campo, halo_t *halo);
+
+/* Actualiza las celdas de halo de 'campo' con las caras de los vecinos */
+int halo_intercambiar(halo_t *halo);
+
+/* Libera tipos, requests persistentes y el comunicador cartesiano */
+void halo_liberar(halo_t *halo);
+
+/* Nombre legible del backend (para reportes) */
+const char *halo_nombre_backend(halo_backend_t backend);
+
+#endif /* HALO_MPI_H */
@@ -0,0 +1,231 @@
+/*
+ ============================================================================
+ Name        : intercambio_halo_mpi.c
+ Compile     : mpicc -g -O2 intercambio_halo_mpi.c halo_mpi.c -o intercambio_halo_mpi.exe
+ Run         : mpiexec  -n 8 ./intercambio_halo_mpi [ndims] [celdas_por_dim] [iteraciones] [backend|todos]
+ Description : Benchmark de escalamiento debil del intercambio de halos.
+               Cada proceso mantiene un bloque fijo de celdas_por_dim^ndims
+               celdas (mas el halo) y se mide el tiempo por intercambio al
+               crecer el numero de procesos. Tras el primer intercambio se
+               verifica que cada halo contenga los datos del vecino correcto.
+ ============================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mpi.h"
+#include "halo_mpi.h"
+#include "tiempo_mpi.h"
+
+#define NDIMS_DEFECTO 2
+#define CELDAS_DEFECTO 256
+#define ITERACIONES_DEFECTO 100
+#define ANCHO_HALO 1
+
+/* Valor que cada proceso escribe en su interior: rango + 1 (los halos empiezan en -1) */
+static float valor_de(int rango)
+{
+    return (rango == MPI_PROC_NULL) ? -1.0f : (float)(rango + 1);
+}
+
+static void inicializar(const halo_t *halo, float *campo)
+{
+    int rango, t[3] = {1, 1, 1}, i[3], d, pad = 3 - halo->ndims, fuera;
+
+    MPI_Comm_rank(halo->comm_cart, &rango);
+    for (d = 0; d < halo->ndims; d++)
+        t[pad + d] = halo->total[d];
+
+    for (i[0] = 0; i[0] < t[0]; i[0]++)
+        for (i[1] = 0; i[1] < t[1]; i[1]++)
+            for (i[2] = 0; i[2] < t[2]; i[2]++)
+            {
+                fuera = 0;
+                for (d = 0; d < halo->ndims; d++)
+                    if (i[pad + d] < halo->ancho || i[pad + d] >= halo->ancho + halo->local[d])
+                        fuera = 1;
+                campo[((long)i[0] * t[1] + i[1]) * t[2] + i[2]] = fuera ? -1.0f : valor_de(rango);
+            }
+}
+
+/* Devuelve el numero de celdas con un valor inesperado */
+static long verificar(const halo_t *halo, const float *campo)
+{
+    int rango, t[3] = {1, 1, 1}, i[3], d, pad = 3 - halo->ndims, fuera, dim_fuera = 0, lado = 0;
+    long errores = 0;
+    float esperado;
+
+    MPI_Comm_rank(halo->comm_cart, &rango);
+    for (d = 0; d < halo->ndims; d++)
+        t[pad + d] = halo->total[d];
+
+    for (i[0] = 0; i[0] < t[0]; i[0]++)
+        for (i[1] = 0; i[1] < t[1]; i[1]++)
+            for (i[2] = 0; i[2] < t[2]; i[2]++)
+            {
+                fuera = 0;
+                for (d = 0; d < halo->ndims; d++)
+                {
+                    if (i[pad + d] < halo->ancho)
+                    {
+                        fuera++;
+                        dim_fuera = d;
+                        lado = 0;
+                    }
+                    else if (i[pad + d] >= halo->ancho + halo->local[d])
+                    {
+                        fuera++;
+                        dim_fuera = d;
+                        lado = 1;
+                    }
+                }
+                if (fuera == 0)
+                    esperado = valor_de(rango);
+                else if (fuera == 1)
+                    esperado = valor_de(halo->vecinos[dim_fuera][lado]);
+                else
+                    esperado = -1.0f; /* esquinas: no se intercambian */
+
+                if (campo[((long)i[0] * t[1] + i[1]) * t[2] + i[2]] != esperado)
+                    errores++;
+            }
+    return errores;
+}
+
+/* Mide un backend y devuelve el tiempo local de sus 'iteraciones' intercambios */
+static double ejecutar(halo_backend_t backend, int ndims, int celdas, int iteraciones)
+{
+    int local[HALO_MAX_DIMS], d, rango, size, rc;
+    long total_celdas = 1, errores, errores_totales;
+    double t1, t2, tiempo, tiempo_max, tiempo_min, bytes_cara = 0.0;
+    float *campo;
+    halo_t halo;
+
+    for (d = 0; d < ndims; d++)
+    {
+        local[d] = celdas;
+        total_celdas *= celdas + 2 * ANCHO_HALO;
+    }
+    campo = (float *)malloc(total_celdas * sizeof(float));
+    if (campo == NULL)
+    {
+        fprintf(stderr, "Error reservando %ld celdas\n", total_celdas);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    rc = halo_crear(MPI_COMM_WORLD, ndims, local, ANCHO_HALO, 1, backend, campo, &halo);
+    if (rc != MPI_SUCCESS)
+    {
+        fprintf(stderr, "Error creando el intercambio de halos (%d)\n", rc);
+        MPI_Abort(MPI_COMM_WORLD, rc);
+    }
+    MPI_Comm_rank(halo.comm_cart, &rango);
+    MPI_Comm_size(halo.comm_cart, &size);
+
+    /* primer intercambio: verificacion de correctitud */
+    inicializar(&halo, campo);
+    halo_intercambiar(&halo);
+    errores = verificar(&halo, campo);
+    MPI_Reduce(&errores, &errores_totales, 1, MPI_LONG, MPI_SUM, 0, halo.comm_cart);
+
+    /* bytes enviados por intercambio (todas las caras de este proceso) */
+    for (d = 0; d < ndims; d++)
+    {
+        double celdas_cara = ANCHO_HALO;
+        int k;
+        for (k = 0; k < ndims; k++)
+            if (k != d)
+                celdas_cara *= celdas;
+        bytes_cara += 2.0 * celdas_cara * sizeof(float);
+    }
+
+    MPI_Barrier(halo.comm_cart);
+    t1 = MPI_Wtime();
+    for (d = 0; d < iteraciones; d++)
+        halo_intercambiar(&halo);
+    t2 = MPI_Wtime();
+    tiempo = (t2 - t1) / iteraciones;
+
+    MPI_Reduce(&tiempo, &tiempo_max, 1, MPI_DOUBLE, MPI_MAX, 0, halo.comm_cart);
+    MPI_Reduce(&tiempo, &tiempo_min, 1, MPI_DOUBLE, MPI_MIN, 0, halo.comm_cart);
+
+    if (rango == 0)
+    {
+        char malla[32];
+        if (ndims == 1)
+            sprintf(malla, "%d", halo.dims[0]);
+        else if (ndims == 2)
+            sprintf(malla, "%dx%d", halo.dims[0], halo.dims[1]);
+        else
+            sprintf(malla, "%dx%dx%d", halo.dims[0], halo.dims[1], halo.dims[2]);
+
+        printf("%-20s %6d %10s %14.3f %14.3f %12.2f   %s\n",
+               halo_nombre_backend(backend), size, malla,
+               tiempo_min * 1e6, tiempo_max * 1e6,
+               bytes_cara / tiempo_max / 1e6,
+               errores_totales == 0 ? "OK" : "FALLA");
+    }
+
+    halo_liberar(&halo);
+    free(campo);
+    return t2 - t1;
+}
+
+int main(int argc, char **argv)
+{
+    int rango, ndims, celdas, iteraciones, b, primero, ultimo;
+    double t_inicio, t_intercambios = 0.0;
+
+    MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
+    MPI_Comm_rank(MPI_COMM_WORLD, &rango);
+
+    ndims = (argc > 1) ? atoi(argv[1]) : NDIMS_DEFECTO;
+    celdas = (argc > 2) ? atoi(argv[2]) : CELDAS_DEFECTO;
+    iteraciones = (argc > 3) ? atoi(argv[3]) : ITERACIONES_DEFECTO;
+
+    if (ndims < 1 || ndims > HALO_MAX_DIMS || celdas < ANCHO_HALO || iteraciones < 1)
+    {
+        if (rango == 0)
+            printf("Uso: %s [ndims 1..3] [celdas_por_dim] [iteraciones] [backend|todos]\n", argv[0]);
+        MPI_Finalize();
+        return 0;
+    }
+
+    /* backend a medir: por defecto todos */
+    primero = 0;
+    ultimo = HALO_NUM_BACKENDS - 1;
+    if (argc > 4 && strcmp(argv[4], "todos") != 0)
+    {
+        for (b = 0; b < HALO_NUM_BACKENDS; b++)
+            if (strcmp(argv[4], halo_nombre_backend((halo_backend_t)b)) == 0)
+                primero = ultimo = b;
+        if (primero != ultimo)
+        {
+            if (rango == 0)
+                printf("Backend desconocido: %s\n", argv[4]);
+            MPI_Finalize();
+            return 0;
+        }
+    }
+
+    if (rango == 0)
+    {
+        printf("\n******************** Intercambio de halos (escalamiento debil) ********************\n");
+        printf("Dimensiones = %d, celdas locales por dimension = %d, halo = %d, iteraciones = %d\n",
+               ndims, celdas, ANCHO_HALO, iteraciones);
+        printf("%-20s %6s %10s %14s %14s %12s   %s\n",
+               "backend", "procs", "malla", "min (us/it)", "max (us/it)", "MB/s/proc", "verif.");
+    }
+
+    for (b = primero; b <= ultimo; b++)
+        t_intercambios += ejecutar((halo_backend_t)b, ndims, celdas, iteraciones);
+
+    /* nucleo: solo los bucles de intercambio; con un backend, us_por_repeticion es su max (us/it) */
+    reportar_tiempo_nucleo("intercambio_halo_mpi", t_intercambios,
+                           (long)iteraciones * (ultimo - primero + 1), MPI_COMM_WORLD);
+    reportar_tiempo_pared("intercambio_halo_mpi", t_inicio, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return 0;
+}
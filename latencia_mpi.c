@@ -10,6 +10,7 @@
  * ULTIMA REVISION: 04/13/05
  ******************************************************************************/
 #include "mpi.h"
+#include "tiempo_mpi.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/time.h>
@@ -28,11 +29,13 @@ int main(int argc, char *argv[])
         n;
     double T1, T2,     /* tiempos de inicio/fin por repeticion */
         suma_T,        /* suma de todos los tiempos de repeticiones */
-        deltaT;        /* time for one rep */
+        deltaT,        /* time for one rep */
+        t_inicio;      /* tiempo de pared del programa */
     char msg;          /* buffer containing 1 byte message */
     MPI_Status status; /* MPI receive routine parameter */
 
     MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
     MPI_Comm_size(MPI_COMM_WORLD, &numero_tareas);
     MPI_Comm_rank(MPI_COMM_WORLD, &rango);
     if (rango == 0 && numero_tareas != 2)
@@ -116,6 +119,7 @@ int main(int argc, char *argv[])
         }
     }
 
+    reportar_tiempo_pared("latencia_mpi", t_inicio, MPI_COMM_WORLD);
     MPI_Finalize();
     exit(0);
 }
@@ -1,17 +1,129 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "mpi.h"
+#if defined(OPEN_MPI) && OPEN_MPI
+#include <mpi-ext.h> /* MPIX_Allreduce_init (extension pcollreq) */
+#endif
+#include "particion_mpi.h"
+#include "cuantiles_mpi.h"
+#include "tiempo_mpi.h"
+
+#define ARCHIVO_PESOS "minimos_cuadrados.pesos" /* rendimientos de la ejecucion anterior */
+
+/* Modos de ajuste: minimos cuadrados ordinarios o regresion robusta (IRLS) */
+#define MODO_OLS 0
+#define MODO_HUBER 1
+#define MODO_TUKEY 2
+#define C_HUBER 1.345          /* constantes de afinamiento usuales (95% de eficiencia) */
+#define C_TUKEY 4.685
+#define TOLERANCIA_IRLS 1e-8   /* cambio relativo de m y b para declarar convergencia */
+#define MAX_ITERACIONES_IRLS 50
+
+static const char *nombres_modo[] = {"ols", "huber", "tukey"};
+
+/* Allreduce persistente de IRLS, si la implementacion lo tiene:
+ *   MPI >= 4                   MPI_Allreduce_init (no verificado en este arbol)
+ *   Open MPI 4.x (pcollreq)    MPIX_Allreduce_init
+ *   MPICH >= 3.3               MPIX_Allreduce_init (no verificado en este arbol)
+ * Si no, cada iteracion lanza un MPI_Iallreduce nuevo sobre los mismos buffers.
+ * RUTA_IRLS queda en la linea IRLS para saber cual se midio. */
+#if MPI_VERSION >= 4
+#define ALLREDUCE_PERSISTENTE MPI_Allreduce_init
+#define RUTA_IRLS "allreduce_init"
+#elif (defined(OMPI_HAVE_MPI_EXT_PCOLLREQ) && OMPI_HAVE_MPI_EXT_PCOLLREQ) || \
+      (defined(MPICH_NUMVERSION) && MPICH_NUMVERSION >= 30300000)
+#define ALLREDUCE_PERSISTENTE MPIX_Allreduce_init
+#define RUTA_IRLS "mpix_allreduce_init"
+#else
+#define RUTA_IRLS "iallreduce"
+#endif
+
+/* Peso de un punto en funcion de su residual escalado u = r / s */
+static double peso_robusto(int modo, double u) {
+    double a = fabs(u);
+    if (modo == MODO_HUBER)
+        return (a <= C_HUBER) ? 1.0 : C_HUBER / a;
+    /* Tukey (bicuadrado): los puntos con |u| >= c no pesan */
+    if (a >= C_TUKEY)
+        return 0.0;
+    double t = 1.0 - (u / C_TUKEY) * (u / C_TUKEY);
+    return t * t;
+}
+
+/* sumas[] = {Sw, Swx, Swy, Swxy, Swxx} locales; con escala 0 todos los pesos valen 1 */
+static void sumas_ponderadas(const double *x, const double *y, int n, int modo,
+                             double m, double b, double escala, double *sumas) {
+    double sw = 0.0, swx = 0.0, swy = 0.0, swxy = 0.0, swxx = 0.0;
+    for (int j = 0; j < n; ++j) {
+        double xv = x[j], yv = y[j];
+        double w = (escala > 0.0) ? peso_robusto(modo, (yv - (m * xv + b)) / escala) : 1.0;
+        sw += w;
+        swx += w * xv;
+        swy += w * yv;
+        swxy += w * xv * yv;
+        swxx += w * xv * xv;
+    }
+    sumas[0] = sw;
+    sumas[1] = swx;
+    sumas[2] = swy;
+    sumas[3] = swxy;
+    sumas[4] = swxx;
+}
+
+/* Ecuaciones normales ponderadas; devuelve 0 si el sistema es singular */
+static int resolver_ponderado(const double *sumas, double *m, double *b) {
+    double det = sumas[0] * sumas[4] - sumas[1] * sumas[1];
+    if (sumas[0] <= 0.0 || fabs(det) <= 1e-12 * sumas[0] * sumas[4])
+        return 0;
+    *m = (sumas[0] * sumas[3] - sumas[1] * sumas[2]) / det;
+    *b = (sumas[2] - *m * sumas[1]) / sumas[0];
+    return 1;
+}
+
+/* Escala robusta de los residuales, s = MAD / 0.6745 (colectiva: todos reciben s) */
+static double escala_mad(const double *x, const double *y, int n, double m, double b) {
+    double *r = (double *) malloc((n > 0 ? n : 1) * sizeof(double));
+    double p = 0.5, mediana, mad;
+
+    /* en double: en float la MAD de datos grandes o muy juntos se pierde al redondear */
+    for (int j = 0; j < n; ++j)
+        r[j] = y[j] - (m * x[j] + b);
+    cuantiles_exactos_double(r, n, &p, 1, &mediana, MPI_COMM_WORLD);
+    for (int j = 0; j < n; ++j)
+        r[j] = fabs(r[j] - mediana);
+    cuantiles_exactos_double(r, n, &p, 1, &mad, MPI_COMM_WORLD);
+    free(r);
+    return mad / 0.6745;
+}
 
 int main(int argc, char **argv) {
     int mi_id, numero_procesos;
+    double t_inicio;
     MPI_Init(&argc, &argv);
+    t_inicio = MPI_Wtime();
     MPI_Comm_rank(MPI_COMM_WORLD, &mi_id);
     MPI_Comm_size(MPI_COMM_WORLD, &numero_procesos);
 
+    /* argumentos: [ols|huber|tukey] [tolerancia] [max_iteraciones] */
+    int modo = MODO_OLS;
+    double tolerancia = (argc > 2) ? atof(argv[2]) : TOLERANCIA_IRLS;
+    int max_iteraciones = (argc > 3) ? atoi(argv[3]) : MAX_ITERACIONES_IRLS;
+    if (argc > 1) {
+        modo = -1;
+        for (int k = 0; k < 3; ++k)
+            if (strcmp(argv[1], nombres_modo[k]) == 0) modo = k;
+    }
+    if (modo < 0 || tolerancia <= 0.0 || max_iteraciones < 1) {
+        if (mi_id == 0) printf("Uso: %s [ols|huber|tukey] [tolerancia] [max_iteraciones]\n", argv[0]);
+        MPI_Finalize();
+        return 0;
+    }
+
     int n = 0; /* numero de puntos total */
     double *x_full = NULL, *y_full = NULL; /* solo usados por proceso 0 */
-    int promedio_n, n_restante;
+    particion_t particion;
 
     /* Variables locales para cada proceso */
     int mis_puntos = 0;
@@ -67,22 +179,18 @@ int main(int argc, char **argv) {
         return 0;
     }
 
-    /* calcular reparto equilibrado: los primeros n_restante procesos obtienen q+1 */
-    promedio_n = n / numero_procesos;     /* q */
-    n_restante = n % numero_procesos;     /* r */
-    /* Para cada proceso p:
-     *   if (p < r) mis_puntos = q+1, desplazamiento = p*(q+1)
-     *   else mis_puntos = q, desplazamiento = r*(q+1) + (p-r)*q
-     * Esto equilibra la carga mejor que dar todo al ultimo proceso.
-     */
+    /* tiempo de nucleo: desde aqui (sin la lectura serial del proceso 0) hasta el fin de IRLS */
+    double t_nucleo = MPI_Wtime();
 
-    if (mi_id < n_restante) {
-        mis_puntos = promedio_n + 1;
-        desplazamiento = mi_id * mis_puntos;
-    } else {
-        mis_puntos = promedio_n;
-        desplazamiento = n_restante * (promedio_n + 1) + (mi_id - n_restante) * promedio_n;
-    }
+    /* calcular reparto ponderado: cada proceso recibe una parte proporcional al
+     * rendimiento que midio en la ejecucion anterior (ARCHIVO_PESOS). Sin ese
+     * archivo todos pesan igual y el reparto es el q/r de bloques iguales:
+     * los primeros n % P procesos obtienen n / P + 1.
+     */
+    particion_crear(&particion, MPI_COMM_WORLD, ARCHIVO_PESOS);
+    particion_repartir(&particion, n);
+    mis_puntos = (int) particion.cantidades[mi_id];
+    desplazamiento = (int) particion.inicios[mi_id];
 
     /* Todos reservan espacio para su porcion local */
     if (mis_puntos > 0) {
@@ -112,14 +220,8 @@ int main(int argc, char **argv) {
 
         /* enviar los fragmentos a los procesos 1..P-1 de forma no bloqueante */
         for (int p = 1; p < numero_procesos; ++p) {
-            int p_mis_puntos, p_desplazamiento;
-            if (p < n_restante) {
-                p_mis_puntos = promedio_n + 1;
-                p_desplazamiento = p * p_mis_puntos;
-            } else {
-                p_mis_puntos = promedio_n;
-                p_desplazamiento = n_restante * (promedio_n + 1) + (p - n_restante) * promedio_n;
-            }
+            int p_mis_puntos = (int) particion.cantidades[p];
+            int p_desplazamiento = (int) particion.inicios[p];
 
             /* Enviar primero la cantidad p_mis_puntos (int) */
             MPI_Isend(&p_mis_puntos, 1, MPI_INT, p, 110, MPI_COMM_WORLD, &req);
@@ -170,6 +272,7 @@ int main(int argc, char **argv) {
      * Paso 2: Cada proceso calcula sus sumas parciales
      ******************************/
     double miSUMAx = 0.0, miSUMAy = 0.0, miSUMAxy = 0.0, miSUMAxx = 0.0;
+    double t_sumas = MPI_Wtime();
     for (int j = 0; j < mis_puntos; ++j) {
         double xv = x_local[j];
         double yv = y_local[j];
@@ -178,10 +281,13 @@ int main(int argc, char **argv) {
         miSUMAxy += xv * yv;
         miSUMAxx += xv * xv;
     }
+    t_sumas = MPI_Wtime() - t_sumas;
 
-    /* Liberar memoria local de los datos (opcional) */
-    free(x_local);
-    free(y_local);
+    /* tiempos reales de cada proceso: desbalance y pesos para la proxima ejecucion */
+    particion_rebalancear(&particion, t_sumas);
+    particion_guardar(&particion, ARCHIVO_PESOS);
+
+    /* Liberar los datos completos del proceso 0; los locales siguen residentes para IRLS */
     if (mi_id == 0) {
         free(x_full);
         free(y_full);
@@ -232,6 +338,78 @@ int main(int argc, char **argv) {
         step *= 2;
     }
 
+    /******************************
+     * Paso 4 (modos huber y tukey): regresion robusta por minimos cuadrados
+     *           iterativamente reponderados (IRLS)
+     *
+     *  - los datos locales quedan residentes; cada iteracion los recorre una vez
+     *    con el ajuste anterior y reduce 5 sumas ponderadas con una sola
+     *    allreduce persistente (ALLREDUCE_PERSISTENTE); sin ella se relanza
+     *    MPI_Iallreduce sobre los mismos buffers en cada iteracion.
+     *  - la iteracion 0 usa pesos 1 (minimos cuadrados ordinarios); con sus
+     *    residuales se fija una vez la escala s = MAD / 0.6745.
+     *  - termina cuando m y b cambian menos que 'tolerancia' (relativa).
+     ******************************/
+    int iteraciones = 0, convergio = 0;
+    double m_robusta = 0.0, b_robusta = 0.0, escala = 0.0;
+    double t_iteraciones = 0.0, t_iteracion_max = 0.0;
+    if (modo != MODO_OLS) {
+        double locales[5], globales[5], m_nueva, b_nueva;
+        MPI_Request peticion;
+#ifdef ALLREDUCE_PERSISTENTE
+        ALLREDUCE_PERSISTENTE(locales, globales, 5, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD,
+                              MPI_INFO_NULL, &peticion);
+#endif
+        MPI_Barrier(MPI_COMM_WORLD);
+        for (int it = 0; it <= max_iteraciones; ++it) {
+            double t1 = MPI_Wtime();
+            sumas_ponderadas(x_local, y_local, mis_puntos, modo, m_robusta, b_robusta, escala, locales);
+#ifdef ALLREDUCE_PERSISTENTE
+            MPI_Start(&peticion);
+#else
+            MPI_Iallreduce(locales, globales, 5, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD, &peticion);
+#endif
+            MPI_Wait(&peticion, &status);
+            /* todos reciben las mismas sumas: las decisiones siguientes son identicas en todos */
+            int resuelto = resolver_ponderado(globales, &m_nueva, &b_nueva);
+            t_iteraciones += MPI_Wtime() - t1;
+            iteraciones = it;
+            if (!resuelto)
+                break;
+
+            if (it > 0 && fabs(m_nueva - m_robusta) <= tolerancia * (1.0 + fabs(m_robusta))
+                        && fabs(b_nueva - b_robusta) <= tolerancia * (1.0 + fabs(b_robusta)))
+                convergio = 1;
+            m_robusta = m_nueva;
+            b_robusta = b_nueva;
+            if (convergio)
+                break;
+
+            if (it == 0) {
+                escala = escala_mad(x_local, y_local, mis_puntos, m_robusta, b_robusta);
+                if (escala <= 0.0) { /* ajuste exacto: no hay residuales que reponderar */
+                    convergio = 1;
+                    break;
+                }
+            }
+        }
+#ifdef ALLREDUCE_PERSISTENTE
+        MPI_Request_free(&peticion);
+#endif
+        /* tiempo por iteracion (incluye la pasada 0 de minimos cuadrados ordinarios) */
+        t_iteraciones /= iteraciones + 1;
+        MPI_Reduce(&t_iteraciones, &t_iteracion_max, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
+
+    t_nucleo = MPI_Wtime() - t_nucleo;
+
+    free(x_local);
+    free(y_local);
+
+    /* tiempos sin contar la impresion de residuales */
+    reportar_tiempo_nucleo("minimos_cuadrados_solucion", t_nucleo, 0, MPI_COMM_WORLD);
+    reportar_tiempo_pared("minimos_cuadrados_solucion", t_inicio, MPI_COMM_WORLD);
+
     /* Al final, el proceso 0 tiene las sumas totales en sums[] */
     if (mi_id == 0) {
         double SUMAx = sums[0];
@@ -244,31 +422,56 @@ int main(int argc, char **argv) {
         double interseccion_y = (SUMAy - pendiente * SUMAx) / (double) n;
 
         printf("\nResultado (proceso 0):\n");
-        printf("  n = %d, procesos = %d\n\n", n, numero_procesos);
+        printf("  n = %d, procesos = %d\n", n, numero_procesos);
+        particion_reportar(&particion, stdout);
+        printf("\n");
         printf("  Pendiente (m) = %12.6f\n", pendiente);
         printf("  Intersección y (b) = %12.6f\n\n", interseccion_y);
 
+        if (modo != MODO_OLS) {
+            printf("Regresion robusta (%s, IRLS):\n", nombres_modo[modo]);
+            printf("  Escala (MAD / 0.6745) = %12.6f\n", escala);
+            printf("  Iteraciones = %d (%s, tolerancia %g)\n", iteraciones,
+                   convergio ? "convergio" : "sin converger", tolerancia);
+            printf("  Tiempo por iteracion = %.3f us (max entre procesos, %s)\n", t_iteracion_max * 1e6, RUTA_IRLS);
+            printf("  Pendiente (m) = %12.6f\n", m_robusta);
+            printf("  Intersección y (b) = %12.6f\n\n", b_robusta);
+            printf("IRLS modo=%s n=%d procesos=%d iteraciones=%d convergio=%d us_por_iteracion=%.3f ruta=%s\n\n",
+                   nombres_modo[modo], n, numero_procesos, iteraciones, convergio, t_iteracion_max * 1e6,
+                   RUTA_IRLS);
+            /* los residuales se muestran respecto al ajuste robusto */
+            pendiente = m_robusta;
+            interseccion_y = b_robusta;
+        }
+
         /* opcional: si queremos imprimir residuales, necesitamos los datos completos
          * que antes tenía el proceso 0 en x_full,y_full. Como los liberamos para ahorrar memoria,
          * podemos reabrir el archivo y volver a leer para mostrar los residuales.
-         * (Esto es opcional y puede quitarse si no se desea.)
+         * Con MINIMOS_LISTAR_RESIDUALES=0 solo se imprime la suma (escalamiento.sh
+         * lo usa para no escribir una linea por punto en cada ejecucion).
          */
+        const char *listar_env = getenv("MINIMOS_LISTAR_RESIDUALES");
+        int listar = (listar_env == NULL || atoi(listar_env) != 0);
         FILE *f = fopen("datos_xy.txt", "r");
         if (f) {
             int nn;
             fscanf(f, "%d", &nn);
             double xi, yi;
-            printf("   Original (x,y)     Y estimado     Residual\n");
-            printf("--------------------------------------------------\n");
+            if (listar) {
+                printf("   Original (x,y)     Y estimado     Residual\n");
+                printf("--------------------------------------------------\n");
+            }
             double suma_residual = 0.0;
             for (int i = 0; i < nn; ++i) {
                 fscanf(f, "%lf %lf", &xi, &yi);
                 double y_est = pendiente * xi + interseccion_y;
                 double resid = yi - y_est;
                 suma_residual += resid * resid;
-                printf("   (%8.4lf, %8.4lf)    %12.6lf   %12.6lf\n", xi, yi, y_est, resid);
+                if (listar)
+                    printf("   (%8.4lf, %8.4lf)    %12.6lf   %12.6lf\n", xi, yi, y_est, resid);
             }
-            printf("--------------------------------------------------\n");
+            if (listar)
+                printf("--------------------------------------------------\n");
             printf("Suma residual = %12.6f\n", suma_residual);
             fclose(f);
         } else {
@@ -276,6 +479,7 @@ int main(int argc, char **argv) {
         }
     }
 
+    particion_liberar(&particion);
     MPI_Finalize();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,253 @@
+/*
+ ============================================================================
+ Name        : particion_mpi.c
+ Description : Implementacion del reparto ponderado (ver particion_mpi.h).
+ ============================================================================
+*/
+
+#include <stdlib.h>
+#include <math.h>
+#include "particion_mpi.h"
+
+#define PARTICION_REPORTE_MAX 16 /* procesos listados uno por uno en el reporte */
+
+int particion_crear(particion_t *p, MPI_Comm comm, const char *archivo_pesos)
+{
+    int i, cargados = 0, procesos;
+    FILE *archivo;
+
+    p->comm = comm;
+    MPI_Comm_rank(comm, &p->rango);
+    MPI_Comm_size(comm, &p->tamano);
+    p->n = 0;
+    p->inicios = (long long *)calloc(p->tamano, sizeof(long long));
+    p->cantidades = (long long *)calloc(p->tamano, sizeof(long long));
+    p->rendimientos = (double *)malloc(p->tamano * sizeof(double));
+    p->desbalance_uniforme = p->desbalance_predicho = 1.0;
+    p->desbalance_real = 0.0;
+    for (i = 0; i < p->tamano; i++)
+        p->rendimientos[i] = 1.0;
+
+    if (p->rango == 0 && archivo_pesos != NULL && (archivo = fopen(archivo_pesos, "r")) != NULL)
+    {
+        if (fscanf(archivo, "%d", &procesos) == 1 && procesos == p->tamano)
+        {
+            cargados = 1;
+            for (i = 0; i < p->tamano && cargados; i++)
+                if (fscanf(archivo, "%lf", &p->rendimientos[i]) != 1 || !(p->rendimientos[i] > 0.0))
+                    cargados = 0;
+            if (!cargados)
+                for (i = 0; i < p->tamano; i++)
+                    p->rendimientos[i] = 1.0;
+        }
+        fclose(archivo);
+    }
+
+    MPI_Bcast(&cargados, 1, MPI_INT, 0, comm);
+    MPI_Bcast(p->rendimientos, p->tamano, MPI_DOUBLE, 0, comm);
+    return cargados;
+}
+
+/* ---------------------------------------------------------------
+ * Metodo del mayor resto: cada proceso recibe floor(n * w_i / W) y
+ * los elementos sobrantes van a los de mayor parte fraccionaria
+ * (a igualdad, al de menor rango). Todos los procesos hacen la
+ * misma cuenta con los mismos rendimientos, asi que no hace falta
+ * comunicar el reparto.
+ * --------------------------------------------------------------- */
+static const double *fracciones_orden; /* para ordenar_por_fraccion */
+
+static int ordenar_por_fraccion(const void *a, const void *b)
+{
+    int i = *(const int *)a, j = *(const int *)b;
+
+    if (fracciones_orden[i] > fracciones_orden[j])
+        return -1;
+    if (fracciones_orden[i] < fracciones_orden[j])
+        return 1;
+    return i - j;
+}
+
+/* max/media del tiempo predicho cantidad_i / rendimiento_i */
+static double desbalance_predicho(const particion_t *p, const long long *cantidades)
+{
+    double tiempo, t_max = 0.0, t_suma = 0.0;
+    int i;
+
+    for (i = 0; i < p->tamano; i++)
+    {
+        tiempo = (double)cantidades[i] / p->rendimientos[i];
+        t_suma += tiempo;
+        if (tiempo > t_max)
+            t_max = tiempo;
+    }
+    return (t_suma > 0.0) ? t_max * p->tamano / t_suma : 1.0;
+}
+
+void particion_repartir(particion_t *p, long long n)
+{
+    double total = 0.0, ideal, *fracciones;
+    long long asignados = 0, inicio = 0, *uniforme;
+    int i, *orden;
+
+    fracciones = (double *)malloc(p->tamano * sizeof(double));
+    orden = (int *)malloc(p->tamano * sizeof(int));
+
+    for (i = 0; i < p->tamano; i++)
+        total += p->rendimientos[i];
+    for (i = 0; i < p->tamano; i++)
+    {
+        ideal = (double)n * p->rendimientos[i] / total;
+        p->cantidades[i] = (long long)floor(ideal);
+        if (p->cantidades[i] > n)
+            p->cantidades[i] = n;
+        fracciones[i] = ideal - (double)p->cantidades[i];
+        asignados += p->cantidades[i];
+        orden[i] = i;
+    }
+
+    fracciones_orden = fracciones;
+    qsort(orden, p->tamano, sizeof(int), ordenar_por_fraccion);
+    for (i = 0; asignados < n; i = (i + 1) % p->tamano)
+    {
+        p->cantidades[orden[i]]++;
+        asignados++;
+    }
+    while (asignados > n) /* solo por redondeo extremo */
+        for (i = p->tamano - 1; i >= 0 && asignados > n; i--)
+            if (p->cantidades[orden[i]] > 0)
+            {
+                p->cantidades[orden[i]]--;
+                asignados--;
+            }
+
+    for (i = 0; i < p->tamano; i++)
+    {
+        p->inicios[i] = inicio;
+        inicio += p->cantidades[i];
+    }
+    p->n = n;
+    p->desbalance_predicho = desbalance_predicho(p, p->cantidades);
+
+    /* referencia: el q/r de bloques iguales con los mismos rendimientos */
+    uniforme = (long long *)malloc(p->tamano * sizeof(long long));
+    for (i = 0; i < p->tamano; i++)
+        uniforme[i] = n / p->tamano + (i < n % p->tamano ? 1 : 0);
+    p->desbalance_uniforme = desbalance_predicho(p, uniforme);
+    free(uniforme);
+
+    free(orden);
+    free(fracciones);
+}
+
+void particion_calibrar(particion_t *p, double (*kernel)(long long cantidad, void *contexto),
+                        long long muestra, void *contexto)
+{
+    volatile double sumidero;
+    double t1, medido;
+
+    MPI_Barrier(p->comm);
+    t1 = MPI_Wtime();
+    sumidero = kernel(muestra, contexto);
+    medido = MPI_Wtime() - t1;
+    (void)sumidero;
+
+    medido = (medido > 0.0) ? (double)muestra / medido : 1.0;
+    MPI_Allgather(&medido, 1, MPI_DOUBLE, p->rendimientos, 1, MPI_DOUBLE, p->comm);
+}
+
+void particion_rebalancear(particion_t *p, double tiempo_local)
+{
+    double *tiempos, t_max = 0.0, t_suma = 0.0, media_anterior = 0.0, media_nueva = 0.0, medido;
+    int i;
+
+    tiempos = (double *)malloc(p->tamano * sizeof(double));
+    MPI_Allgather(&tiempo_local, 1, MPI_DOUBLE, tiempos, 1, MPI_DOUBLE, p->comm);
+
+    for (i = 0; i < p->tamano; i++)
+    {
+        t_suma += tiempos[i];
+        if (tiempos[i] > t_max)
+            t_max = tiempos[i];
+    }
+    p->desbalance_real = (t_suma > 0.0) ? t_max * p->tamano / t_suma : 1.0;
+
+    /* con tiempos tan cortos la medicion no dice nada del rendimiento */
+    if (t_max >= PARTICION_TIEMPO_MINIMO)
+    {
+        /* los rendimientos son relativos: se llevan a la misma escala antes de mezclarlos */
+        for (i = 0; i < p->tamano; i++)
+            media_anterior += p->rendimientos[i];
+        for (i = 0; i < p->tamano; i++)
+            if (p->cantidades[i] > 0 && tiempos[i] > 0.0)
+                media_nueva += (double)p->cantidades[i] / tiempos[i];
+            else
+                media_nueva += p->rendimientos[i];
+
+        for (i = 0; i < p->tamano; i++)
+            if (p->cantidades[i] > 0 && tiempos[i] > 0.0)
+            {
+                medido = (double)p->cantidades[i] / tiempos[i] * media_anterior / media_nueva;
+                p->rendimientos[i] = (1.0 - PARTICION_SUAVIZADO) * p->rendimientos[i] +
+                                     PARTICION_SUAVIZADO * medido;
+            }
+    }
+    free(tiempos);
+}
+
+int particion_guardar(const particion_t *p, const char *archivo_pesos)
+{
+    FILE *archivo;
+    int i;
+
+    if (p->rango != 0)
+        return 0;
+    archivo = fopen(archivo_pesos, "w");
+    if (archivo == NULL)
+        return -1;
+    fprintf(archivo, "%d\n", p->tamano);
+    for (i = 0; i < p->tamano; i++)
+        fprintf(archivo, "%.17g\n", p->rendimientos[i]);
+    fclose(archivo);
+    return 0;
+}
+
+void particion_reportar(const particion_t *p, FILE *salida)
+{
+    int i;
+
+    if (p->rango != 0)
+        return;
+    if (p->tamano <= PARTICION_REPORTE_MAX)
+    {
+        fprintf(salida, "  reparto (proceso: elementos)");
+        for (i = 0; i < p->tamano; i++)
+            fprintf(salida, " %d:%lld", i, p->cantidades[i]);
+    }
+    else
+    {
+        long long min = p->cantidades[0], max = p->cantidades[0];
+        for (i = 1; i < p->tamano; i++)
+        {
+            if (p->cantidades[i] < min)
+                min = p->cantidades[i];
+            if (p->cantidades[i] > max)
+                max = p->cantidades[i];
+        }
+        fprintf(salida, "  reparto: entre %lld y %lld elementos por proceso", min, max);
+    }
+    fprintf(salida, "\n  desbalance (max/media) predicho: q/r uniforme = %.3f, este reparto = %.3f",
+            p->desbalance_uniforme, p->desbalance_predicho);
+    if (p->desbalance_real > 0.0)
+        fprintf(salida, "  real = %.3f", p->desbalance_real);
+    fprintf(salida, "\n");
+}
+
+void particion_liberar(particion_t *p)
+{
+    free(p->inicios);
+    free(p->cantidades);
+    free(p->rendimientos);
+    p->inicios = p->cantidades = NULL;
+    p->rendimientos = NULL;
+}
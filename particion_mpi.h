@@ -0,0 +1,77 @@
+/*
+ ============================================================================
+ Name        : particion_mpi.h
+ Description : Reparto de trabajo ponderado por el rendimiento medido de
+               cada proceso. Sustituye el reparto q/r en bloques iguales de
+               aproximacion_pi_solucion.c y minimos_cuadrados_solucion.c
+               (comunicacion_colectiva_solucion.c y estadisticas_orden_mpi.c
+               lo usan con pesos iguales para el q/r de siempre):
+               cada proceso recibe una parte proporcional a su rendimiento
+               (elementos por segundo), obtenido de una calibracion corta,
+               de los tiempos de la ejecucion anterior (archivo de pesos) o
+               de la iteracion anterior, y se reporta el desbalance
+               (tiempo maximo / tiempo medio) que tendria el reparto q/r
+               uniforme con esos rendimientos, el predicho para el reparto
+               ponderado y el real medido.
+               Con pesos iguales el reparto coincide con el q/r original.
+ ============================================================================
+*/
+
+#ifndef PARTICION_MPI_H
+#define PARTICION_MPI_H
+
+#include <stdio.h>
+#include "mpi.h"
+
+/* Por debajo de este tiempo maximo (s) la medicion es ruido y no se cambian los pesos */
+#define PARTICION_TIEMPO_MINIMO 1e-3
+/* Peso de la nueva medicion al suavizar los rendimientos (0..1) */
+#define PARTICION_SUAVIZADO 0.5
+
+typedef struct
+{
+    MPI_Comm comm;
+    int rango, tamano;
+    long long n;            /* elementos repartidos en la ultima llamada a particion_repartir */
+    long long *inicios;     /* por proceso: primer indice global   */
+    long long *cantidades;  /* por proceso: numero de elementos     */
+    double *rendimientos;   /* por proceso: elementos/s (relativos) */
+    double desbalance_uniforme; /* predicho para el q/r uniforme con los rendimientos actuales */
+    double desbalance_predicho; /* predicho para este reparto (solo difiere de 1 por redondeo) */
+    double desbalance_real;     /* 0 si aun no hay medicion */
+} particion_t;
+
+/*
+ * Colectiva. Si 'archivo_pesos' existe (lo lee el proceso 0) y corresponde al mismo
+ * numero de procesos, se usan sus rendimientos; si no, todos valen 1.
+ * Devuelve 1 si se cargaron pesos, 0 si no.
+ */
+int particion_crear(particion_t *p, MPI_Comm comm, const char *archivo_pesos);
+
+/* Local (mismo resultado en todos): reparte n elementos segun los rendimientos */
+void particion_repartir(particion_t *p, long long n);
+
+/*
+ * Colectiva: cada proceso mide 'kernel' sobre 'muestra' elementos y los
+ * rendimientos pasan a ser los medidos. El kernel debe devolver algo que
+ * dependa del calculo para que el compilador no lo elimine.
+ */
+void particion_calibrar(particion_t *p, double (*kernel)(long long cantidad, void *contexto),
+                        long long muestra, void *contexto);
+
+/*
+ * Colectiva: con el tiempo que tardo cada proceso en su parte actual calcula
+ * el desbalance real y actualiza (suavizando) los rendimientos para el
+ * proximo particion_repartir.
+ */
+void particion_rebalancear(particion_t *p, double tiempo_local);
+
+/* El proceso 0 guarda los rendimientos para la proxima ejecucion */
+int particion_guardar(const particion_t *p, const char *archivo_pesos);
+
+/* El proceso 0 imprime el reparto y el desbalance uniforme/predicho/real */
+void particion_reportar(const particion_t *p, FILE *salida);
+
+void particion_liberar(particion_t *p);
+
+#endif /* PARTICION_MPI_H */
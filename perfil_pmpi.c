@@ -0,0 +1,1243 @@
+/*
+ ============================================================================
+ Name        : perfil_pmpi.c
+ Compile     : mpicc -O2 -shared -fPIC perfil_pmpi.c -o libperfil_pmpi.so
+ Run         : mpiexec -n 4 -x LD_PRELOAD=./libperfil_pmpi.so ./programa.exe
+               (o enlazando: mpicc programa.c perfil_pmpi.c -o programa.exe)
+ Description : Capa de perfilado basada en PMPI. Intercepta las llamadas de
+               comunicacion, E/S y creacion de comunicadores que usan los
+               programas del repositorio y acumula, por llamada y por proceso
+               par, el numero de llamadas, los bytes y el tiempo dentro de la
+               llamada. Las peticiones no bloqueantes y persistentes se
+               acreditan al par cuando se completan, con el tiempo bloqueado
+               en MPI_Wait* o MPI_Test*; las recepciones de MPI_ANY_SOURCE se acreditan al
+               origen real del estado. En MPI_Finalize el resumen y el
+               desbalance de carga se reducen en el proceso 0 y cada proceso
+               escribe su propio detalle (con los PERFIL_PMPI_PARES pares de
+               mas tiempo, 16 por defecto) en el mismo archivo <prefijo>.txt
+               con MPI-IO, sin reunir datos por proceso en ningun rango.
+               El prefijo se toma de la variable PERFIL_PMPI_PREFIJO
+               (por defecto "perfil_pmpi").
+               Las llamadas no listadas (RMA, E/S no usada) no se miden y su
+               tiempo cuenta como computo.
+ ============================================================================
+*/
+
+#define _POSIX_C_SOURCE 200809L /* open_memstream */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mpi.h"
+#if defined(OPEN_MPI) && OPEN_MPI
+#include <mpi-ext.h> /* MPIX_Allreduce_init (extension pcollreq) */
+#endif
+
+/* ---------------------------------------------------------------
+ * Llamadas instrumentadas
+ * --------------------------------------------------------------- */
+enum
+{
+    P_SEND, P_RECV, P_ISEND, P_IRECV, P_SENDRECV,
+    P_SEND_INIT, P_RECV_INIT, P_START, P_STARTALL,
+    P_WAIT, P_WAITALL, P_WAITANY, P_WAITSOME,
+    P_TEST, P_TESTALL, P_TESTANY, P_TESTSOME, P_PACK, P_UNPACK,
+    P_BARRIER, P_BCAST, P_REDUCE, P_ALLREDUCE, P_IALLREDUCE, P_ALLREDUCE_INIT,
+    P_EXSCAN, P_GATHER, P_GATHERV, P_ALLGATHER, P_ALLGATHERV,
+    P_SCATTER, P_ALLTOALL, P_NEIGHBOR_ALLTOALLW,
+    P_COMM_DUP, P_COMM_SPLIT, P_COMM_SPLIT_TYPE, P_CART_CREATE,
+    P_FILE_OPEN, P_FILE_SET_SIZE, P_FILE_WRITE_AT_ALL, P_FILE_CLOSE,
+    P_NUM_LLAMADAS
+};
+
+static const char *nombres_llamadas[P_NUM_LLAMADAS] = {
+    "MPI_Send", "MPI_Recv", "MPI_Isend", "MPI_Irecv", "MPI_Sendrecv",
+    "MPI_Send_init", "MPI_Recv_init", "MPI_Start", "MPI_Startall",
+    "MPI_Wait", "MPI_Waitall", "MPI_Waitany", "MPI_Waitsome",
+    "MPI_Test", "MPI_Testall", "MPI_Testany", "MPI_Testsome", "MPI_Pack", "MPI_Unpack",
+    "MPI_Barrier", "MPI_Bcast", "MPI_Reduce", "MPI_Allreduce", "MPI_Iallreduce", "MPI_Allreduce_init",
+    "MPI_Exscan", "MPI_Gather", "MPI_Gatherv", "MPI_Allgather", "MPI_Allgatherv",
+    "MPI_Scatter", "MPI_Alltoall", "MPI_Neighbor_alltoallw",
+    "MPI_Comm_dup", "MPI_Comm_split", "MPI_Comm_split_type", "MPI_Cart_create",
+    "MPI_File_open", "MPI_File_set_size", "MPI_File_write_at_all", "MPI_File_close"};
+
+typedef struct
+{
+    long long llamadas;
+    long long bytes;
+    double tiempo;
+} contador_t;
+
+/* trafico punto a punto con cada proceso par (rangos de MPI_COMM_WORLD) */
+typedef struct
+{
+    long long mensajes_env, bytes_env;
+    long long mensajes_rec, bytes_rec;
+    double tiempo; /* tiempo en llamadas y esperas dirigidas a este par */
+} par_t;
+
+static contador_t contadores[P_NUM_LLAMADAS];
+static par_t *pares = NULL;
+static int rango_mundo = 0, tamano_mundo = 0;
+static double t_inicio = 0.0;
+
+/* ---------------------------------------------------------------
+ * Traduccion de rangos a MPI_COMM_WORLD: cache de grupos de varios
+ * comunicadores (control_mpi alterna entre el del nodo y el de lideres)
+ * --------------------------------------------------------------- */
+#define GRUPOS_CACHE 16
+
+static struct
+{
+    MPI_Comm comm;
+    MPI_Group grupo;
+} cache_grupos[GRUPOS_CACHE];
+static int siguiente_grupo = 0;
+static MPI_Group grupo_mundo = MPI_GROUP_NULL;
+
+static int rango_en_mundo(int rango, MPI_Comm comm)
+{
+    int traducido, i;
+
+    if (rango < 0 || pares == NULL) /* MPI_PROC_NULL, MPI_ANY_SOURCE */
+        return -1;
+    if (comm == MPI_COMM_WORLD)
+        return rango;
+    for (i = 0; i < GRUPOS_CACHE; i++)
+        if (cache_grupos[i].comm == comm)
+            break;
+    if (i == GRUPOS_CACHE)
+    {
+        /* reemplazo circular: solo ocurre con mas de GRUPOS_CACHE comunicadores vivos */
+        i = siguiente_grupo;
+        siguiente_grupo = (siguiente_grupo + 1) % GRUPOS_CACHE;
+        if (cache_grupos[i].grupo != MPI_GROUP_NULL)
+            PMPI_Group_free(&cache_grupos[i].grupo);
+        PMPI_Comm_group(comm, &cache_grupos[i].grupo);
+        cache_grupos[i].comm = comm;
+    }
+    PMPI_Group_translate_ranks(cache_grupos[i].grupo, 1, &rango, grupo_mundo, &traducido);
+    return (traducido == MPI_UNDEFINED) ? -1 : traducido;
+}
+
+static void olvidar_comm(MPI_Comm comm)
+{
+    int i;
+
+    for (i = 0; i < GRUPOS_CACHE; i++)
+        if (cache_grupos[i].comm == comm)
+        {
+            PMPI_Group_free(&cache_grupos[i].grupo);
+            cache_grupos[i].comm = MPI_COMM_NULL;
+        }
+}
+
+/* ---------------------------------------------------------------
+ * Peticiones punto a punto pendientes: se registran al publicarse y
+ * se acreditan al par al completarse. Tabla hash de tamano fijo con
+ * sondeo lineal; si se llena, el par se acredita al publicar.
+ * --------------------------------------------------------------- */
+#define PETICIONES_MAX 4096 /* potencia de 2 */
+
+typedef struct
+{
+    MPI_Request req; /* MPI_REQUEST_NULL: casilla libre */
+    MPI_Comm comm;   /* para traducir MPI_SOURCE de recepciones MPI_ANY_SOURCE */
+    int par;         /* rango en MPI_COMM_WORLD, -1 si se conoce al completar */
+    int recibo;      /* 1 recepcion, 0 envio */
+    int persistente, activa;
+    long long bytes; /* bytes publicados */
+} peticion_t;
+
+static peticion_t peticiones[PETICIONES_MAX];
+static long long peticiones_sin_registro = 0;
+
+/* buffers de trabajo de MPI_Waitall/MPI_Waitany: solo crecen */
+static MPI_Request *copias_trabajo = NULL;
+static MPI_Status *estados_trabajo = NULL;
+static int capacidad_trabajo = 0;
+
+static unsigned int hash_peticion(MPI_Request req)
+{
+    unsigned char b[sizeof(MPI_Request)];
+    unsigned int h = 2166136261u;
+    size_t i;
+
+    memcpy(b, &req, sizeof(req));
+    for (i = 0; i < sizeof(req); i++)
+        h = (h ^ b[i]) * 16777619u;
+    return h & (PETICIONES_MAX - 1);
+}
+
+static int buscar_peticion(MPI_Request req)
+{
+    unsigned int i, k;
+
+    if (req == MPI_REQUEST_NULL || pares == NULL)
+        return -1;
+    for (k = 0, i = hash_peticion(req); k < PETICIONES_MAX; k++, i = (i + 1) & (PETICIONES_MAX - 1))
+    {
+        if (peticiones[i].req == req)
+            return (int)i;
+        if (peticiones[i].req == MPI_REQUEST_NULL)
+            return -1;
+    }
+    return -1;
+}
+
+/* Borrado con desplazamiento hacia atras para no romper las cadenas de sondeo */
+static void quitar_peticion(int hueco)
+{
+    unsigned int i = (unsigned int)hueco, j = i, k;
+
+    peticiones[i].req = MPI_REQUEST_NULL;
+    for (;;)
+    {
+        j = (j + 1) & (PETICIONES_MAX - 1);
+        if (peticiones[j].req == MPI_REQUEST_NULL)
+            return;
+        k = hash_peticion(peticiones[j].req);
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+        peticiones[i] = peticiones[j];
+        peticiones[j].req = MPI_REQUEST_NULL;
+        i = j;
+    }
+}
+
+/* Devuelve 0 si la tabla esta llena */
+static int agregar_peticion(MPI_Request req, MPI_Comm comm, int par, int recibo, int persistente,
+                            long long bytes)
+{
+    unsigned int i, k;
+
+    if (req == MPI_REQUEST_NULL || pares == NULL)
+        return 0;
+    /* No se descartan entradas con el mismo manejador: Open MPI devuelve la
+     * misma peticion ya completada (ompi_request_empty) para todos los envios
+     * cortos que resuelve en el acto, asi que puede haber varias vivas a la vez.
+     * Cada completacion interceptada (MPI_Wait*, MPI_Test*) quita una. */
+    for (k = 0, i = hash_peticion(req); k < PETICIONES_MAX; k++, i = (i + 1) & (PETICIONES_MAX - 1))
+        if (peticiones[i].req == MPI_REQUEST_NULL)
+        {
+            peticiones[i].req = req;
+            peticiones[i].comm = comm;
+            peticiones[i].par = par;
+            peticiones[i].recibo = recibo;
+            peticiones[i].persistente = persistente;
+            peticiones[i].activa = !persistente;
+            peticiones[i].bytes = bytes;
+            return 1;
+        }
+    peticiones_sin_registro++;
+    return 0;
+}
+
+static int preparar_trabajo(int cuenta)
+{
+    if (cuenta > capacidad_trabajo)
+    {
+        MPI_Request *copias = (MPI_Request *)realloc(copias_trabajo, cuenta * sizeof(MPI_Request));
+        MPI_Status *estados;
+
+        if (copias == NULL)
+            return 0;
+        copias_trabajo = copias;
+        estados = (MPI_Status *)realloc(estados_trabajo, cuenta * sizeof(MPI_Status));
+        if (estados == NULL)
+            return 0;
+        estados_trabajo = estados;
+        capacidad_trabajo = cuenta;
+    }
+    return 1;
+}
+
+static void iniciar_perfil(void)
+{
+    int i;
+
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rango_mundo);
+    PMPI_Comm_size(MPI_COMM_WORLD, &tamano_mundo);
+    PMPI_Comm_group(MPI_COMM_WORLD, &grupo_mundo);
+    pares = (par_t *)calloc(tamano_mundo, sizeof(par_t));
+    memset(contadores, 0, sizeof(contadores));
+    for (i = 0; i < GRUPOS_CACHE; i++)
+    {
+        cache_grupos[i].comm = MPI_COMM_NULL;
+        cache_grupos[i].grupo = MPI_GROUP_NULL;
+    }
+    for (i = 0; i < PETICIONES_MAX; i++)
+        peticiones[i].req = MPI_REQUEST_NULL;
+    preparar_trabajo(64);
+    t_inicio = PMPI_Wtime();
+}
+
+static long long bytes_de(int cuenta, MPI_Datatype tipo)
+{
+    int tam;
+
+    if (tipo == MPI_DATATYPE_NULL)
+        return 0;
+    PMPI_Type_size(tipo, &tam);
+    return (long long)cuenta * tam;
+}
+
+static long long bytes_recibidos(const MPI_Status *e)
+{
+    int recibidos = 0;
+
+    PMPI_Get_count(e, MPI_BYTE, &recibidos);
+    return (recibidos == MPI_UNDEFINED) ? 0 : recibidos;
+}
+
+static void registrar(int llamada, long long bytes, double tiempo)
+{
+    contadores[llamada].llamadas++;
+    contadores[llamada].bytes += bytes;
+    contadores[llamada].tiempo += tiempo;
+}
+
+static void acreditar_envio(int par, long long bytes, double tiempo)
+{
+    if (par >= 0)
+    {
+        pares[par].mensajes_env++;
+        pares[par].bytes_env += bytes;
+        pares[par].tiempo += tiempo;
+    }
+}
+
+static void acreditar_recibo(int par, long long bytes, double tiempo)
+{
+    if (par >= 0)
+    {
+        pares[par].mensajes_rec++;
+        pares[par].bytes_rec += bytes;
+        pares[par].tiempo += tiempo;
+    }
+}
+
+/* Peticion en la casilla i completada con estado e tras 'tiempo' bloqueado */
+static void completar_peticion(int i, const MPI_Status *e, double tiempo)
+{
+    peticion_t *p = &peticiones[i];
+
+    if (p->activa)
+    {
+        if (p->recibo)
+            acreditar_recibo(p->par >= 0 ? p->par : rango_en_mundo(e->MPI_SOURCE, p->comm),
+                             bytes_recibidos(e), tiempo);
+        else
+            acreditar_envio(p->par, p->bytes, tiempo);
+    }
+    p->activa = 0;
+    if (!p->persistente)
+        quitar_peticion(i);
+}
+
+/* Registra una peticion publicada; si no cabe en la tabla se acredita ya */
+static void publicar(MPI_Request req, MPI_Comm comm, int rango, int recibo, int persistente,
+                     long long bytes, double tiempo)
+{
+    int par = rango_en_mundo(rango, comm);
+
+    if (!agregar_peticion(req, comm, par, recibo, persistente, bytes))
+    {
+        if (recibo)
+            acreditar_recibo(par, bytes, tiempo);
+        else
+            acreditar_envio(par, bytes, tiempo);
+    }
+}
+
+/* Vecinos de una topologia cartesiana o de grafo, en el orden de las colectivas
+ * de vecindario (para grafos distribuidos solo se cuenta la llamada) */
+#define VECINOS_MAX 64
+
+static int vecinos_topologia(MPI_Comm comm, int *fuentes, int *nf, int *destinos, int *nd)
+{
+    int topo, ndims, d, rango;
+
+    PMPI_Topo_test(comm, &topo);
+    if (topo == MPI_CART)
+    {
+        PMPI_Cartdim_get(comm, &ndims);
+        if (2 * ndims > VECINOS_MAX)
+            return 0;
+        for (d = 0; d < ndims; d++)
+        {
+            PMPI_Cart_shift(comm, d, 1, &fuentes[2 * d], &fuentes[2 * d + 1]);
+            destinos[2 * d] = fuentes[2 * d];
+            destinos[2 * d + 1] = fuentes[2 * d + 1];
+        }
+        *nf = *nd = 2 * ndims;
+        return 1;
+    }
+    if (topo == MPI_GRAPH)
+    {
+        PMPI_Comm_rank(comm, &rango);
+        PMPI_Graph_neighbors_count(comm, rango, nf);
+        if (*nf > VECINOS_MAX)
+            return 0;
+        PMPI_Graph_neighbors(comm, rango, *nf, fuentes);
+        memcpy(destinos, fuentes, *nf * sizeof(int));
+        *nd = *nf;
+        return 1;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------
+ * Inicializacion y finalizacion
+ * --------------------------------------------------------------- */
+int MPI_Init(int *argc, char ***argv)
+{
+    int rc = PMPI_Init(argc, argv);
+    iniciar_perfil();
+    return rc;
+}
+
+int MPI_Init_thread(int *argc, char ***argv, int requerido, int *provisto)
+{
+    int rc = PMPI_Init_thread(argc, argv, requerido, provisto);
+    iniciar_perfil();
+    return rc;
+}
+
+int MPI_Comm_free(MPI_Comm *comm)
+{
+    olvidar_comm(*comm);
+    return PMPI_Comm_free(comm);
+}
+
+int MPI_Request_free(MPI_Request *req)
+{
+    int i = buscar_peticion(*req);
+
+    if (i >= 0)
+    {
+        /* un envio liberado sin esperar igual sale; una recepcion no se puede acreditar */
+        if (peticiones[i].activa && !peticiones[i].recibo)
+            acreditar_envio(peticiones[i].par, peticiones[i].bytes, 0.0);
+        quitar_peticion(i);
+    }
+    return PMPI_Request_free(req);
+}
+
+/* ---------------------------------------------------------------
+ * Escritura del perfil: el resumen se reduce de forma colectiva y
+ * cada proceso formatea su propia seccion, que se escribe con MPI-IO
+ * en el desplazamiento que le da un MPI_Exscan de los tamanos. Ningun
+ * proceso guarda datos de los demas y cada seccion lista a lo sumo
+ * los PARES_DETALLE pares con mas tiempo (el resto va sumado en "otros").
+ * --------------------------------------------------------------- */
+#define PARES_DETALLE 16 /* por defecto; se cambia con PERFIL_PMPI_PARES */
+
+static const par_t *pares_orden; /* para ordenar_pares */
+
+static int ordenar_pares(const void *a, const void *b)
+{
+    const par_t *p = &pares_orden[*(const int *)a], *q = &pares_orden[*(const int *)b];
+
+    if (p->tiempo > q->tiempo)
+        return -1;
+    if (p->tiempo < q->tiempo)
+        return 1;
+    return *(const int *)a - *(const int *)b;
+}
+
+/* Tabla de llamadas y de los pares con mas tiempo de este proceso */
+static void escribir_detalle(FILE *archivo, const double *propios, int max_pares)
+{
+    double t_pared = propios[0];
+    par_t otros;
+    int *orden, num_pares = 0, i;
+
+    fprintf(archivo, "\n---------------- Proceso %d ----------------\n", rango_mundo);
+    fprintf(archivo, "Tiempo total = %12.6f s  MPI = %12.6f s (%5.1f%%)  computo = %12.6f s\n\n",
+            t_pared, propios[1], t_pared > 0 ? 100.0 * propios[1] / t_pared : 0.0, propios[2]);
+
+    fprintf(archivo, "%-22s %12s %16s %14s %7s\n", "llamada", "llamadas", "bytes", "tiempo (s)", "%pared");
+    for (i = 0; i < P_NUM_LLAMADAS; i++)
+        if (contadores[i].llamadas > 0)
+            fprintf(archivo, "%-22s %12lld %16lld %14.6f %6.1f%%\n", nombres_llamadas[i],
+                    contadores[i].llamadas, contadores[i].bytes, contadores[i].tiempo,
+                    t_pared > 0 ? 100.0 * contadores[i].tiempo / t_pared : 0.0);
+
+    orden = (int *)malloc((tamano_mundo > 0 ? tamano_mundo : 1) * sizeof(int));
+    for (i = 0; i < tamano_mundo; i++)
+        if (pares[i].mensajes_env > 0 || pares[i].mensajes_rec > 0)
+            orden[num_pares++] = i;
+    if (num_pares > 0)
+    {
+        pares_orden = pares;
+        qsort(orden, num_pares, sizeof(int), ordenar_pares);
+        fprintf(archivo, "\n%-8s %12s %16s %12s %16s %14s\n", "par", "msj env", "bytes env",
+                "msj rec", "bytes rec", "tiempo (s)");
+        memset(&otros, 0, sizeof(otros));
+        for (i = 0; i < num_pares; i++)
+        {
+            const par_t *p = &pares[orden[i]];
+            if (i < max_pares)
+                fprintf(archivo, "%-8d %12lld %16lld %12lld %16lld %14.6f\n", orden[i], p->mensajes_env,
+                        p->bytes_env, p->mensajes_rec, p->bytes_rec, p->tiempo);
+            else
+            {
+                otros.mensajes_env += p->mensajes_env;
+                otros.bytes_env += p->bytes_env;
+                otros.mensajes_rec += p->mensajes_rec;
+                otros.bytes_rec += p->bytes_rec;
+                otros.tiempo += p->tiempo;
+            }
+        }
+        if (num_pares > max_pares)
+        {
+            char etiqueta[32];
+            snprintf(etiqueta, sizeof(etiqueta), "otros %d", num_pares - max_pares);
+            fprintf(archivo, "%-8s %12lld %16lld %12lld %16lld %14.6f\n", etiqueta, otros.mensajes_env,
+                    otros.bytes_env, otros.mensajes_rec, otros.bytes_rec, otros.tiempo);
+        }
+    }
+    free(orden);
+}
+
+/* Resumen de todos los procesos (solo en el proceso 0, con los datos ya reducidos) */
+typedef struct
+{
+    double valor;
+    int rango;
+} valor_rango_t;
+
+static void escribir_resumen(FILE *archivo, const valor_rango_t *min, const valor_rango_t *max,
+                             const double *suma, const double *llam_suma, const double *llam_max,
+                             long long sin_registro)
+{
+    const char *etiquetas[3] = {"total", "MPI", "computo"};
+    int i, k;
+
+    /* desbalance = (max - media) / max: fraccion del tiempo que el proceso mas
+     * lento podria ahorrar si la carga estuviera perfectamente repartida */
+    fprintf(archivo, "Resumen de %d procesos\n\n", tamano_mundo);
+    fprintf(archivo, "%-8s %12s %6s %12s %12s %6s %8s %10s\n", "tiempo", "min (s)", "proc",
+            "media (s)", "max (s)", "proc", "max/med", "desbal.");
+    for (k = 0; k < 3; k++)
+    {
+        double media = suma[k] / tamano_mundo;
+        fprintf(archivo, "%-8s %12.6f %6d %12.6f %12.6f %6d %8.3f %9.1f%%\n", etiquetas[k],
+                min[k].valor, min[k].rango, media, max[k].valor, max[k].rango,
+                media > 0 ? max[k].valor / media : 0.0,
+                max[k].valor > 0 ? 100.0 * (max[k].valor - media) / max[k].valor : 0.0);
+    }
+
+    fprintf(archivo, "\n%-22s %14s %14s %8s\n", "llamada", "media (s)", "max (s)", "max/med");
+    for (i = 0; i < P_NUM_LLAMADAS; i++)
+        if (llam_max[i] > 0.0)
+        {
+            double media = llam_suma[i] / tamano_mundo;
+            fprintf(archivo, "%-22s %14.6f %14.6f %8.3f\n", nombres_llamadas[i], media, llam_max[i],
+                    media > 0 ? llam_max[i] / media : 0.0);
+        }
+    if (sin_registro > 0)
+        fprintf(archivo, "\nPeticiones fuera de la tabla (acreditadas al publicar): %lld\n", sin_registro);
+    fprintf(archivo, "\nDetalle por proceso:\n");
+}
+
+int MPI_Finalize(void)
+{
+    double t_pared, t_mpi = 0.0, propios[3], suma[3], mis_tiempos[P_NUM_LLAMADAS];
+    double llam_suma[P_NUM_LLAMADAS], llam_max[P_NUM_LLAMADAS];
+    valor_rango_t mios[3], min[3], max[3];
+    const char *prefijo = getenv("PERFIL_PMPI_PREFIJO"), *max_pares_env = getenv("PERFIL_PMPI_PARES");
+    char nombre[512], *texto = NULL;
+    size_t largo = 0;
+    int i, k, rc, max_pares = PARES_DETALLE;
+    long long sin_registro = 0;
+    MPI_Offset tam, desplazamiento = 0;
+    MPI_File archivo;
+    FILE *seccion;
+
+    if (prefijo == NULL || prefijo[0] == '\0')
+        prefijo = "perfil_pmpi";
+    if (max_pares_env != NULL && atoi(max_pares_env) >= 0)
+        max_pares = atoi(max_pares_env);
+    snprintf(nombre, sizeof(nombre), "%s.txt", prefijo);
+
+    t_pared = PMPI_Wtime() - t_inicio;
+    for (i = 0; i < P_NUM_LLAMADAS; i++)
+    {
+        t_mpi += contadores[i].tiempo;
+        mis_tiempos[i] = contadores[i].tiempo;
+    }
+    propios[0] = t_pared;
+    propios[1] = t_mpi;
+    propios[2] = t_pared - t_mpi;
+    for (k = 0; k < 3; k++)
+    {
+        mios[k].valor = propios[k];
+        mios[k].rango = rango_mundo;
+    }
+
+    /* resumen: O(P_NUM_LLAMADAS) por proceso, sin reunir nada por proceso en el 0 */
+    PMPI_Reduce(mios, min, 3, MPI_DOUBLE_INT, MPI_MINLOC, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(mios, max, 3, MPI_DOUBLE_INT, MPI_MAXLOC, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(propios, suma, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(mis_tiempos, llam_suma, P_NUM_LLAMADAS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(mis_tiempos, llam_max, P_NUM_LLAMADAS, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(&peticiones_sin_registro, &sin_registro, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    /* seccion de este proceso (el 0 antepone el resumen) */
+    seccion = open_memstream(&texto, &largo);
+    if (seccion != NULL)
+    {
+        if (rango_mundo == 0)
+            escribir_resumen(seccion, min, max, suma, llam_suma, llam_max, sin_registro);
+        escribir_detalle(seccion, propios, max_pares);
+        fclose(seccion);
+    }
+    else
+        largo = 0;
+
+    tam = (MPI_Offset)largo;
+    PMPI_Exscan(&tam, &desplazamiento, 1, MPI_OFFSET, MPI_SUM, MPI_COMM_WORLD);
+    if (rango_mundo == 0)
+        desplazamiento = 0;
+    rc = PMPI_File_open(MPI_COMM_WORLD, nombre, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &archivo);
+    if (rc == MPI_SUCCESS)
+    {
+        PMPI_File_set_size(archivo, 0);
+        PMPI_File_write_at_all(archivo, desplazamiento, texto, (int)largo, MPI_CHAR, MPI_STATUS_IGNORE);
+        PMPI_File_close(&archivo);
+    }
+    else if (rango_mundo == 0)
+        fprintf(stderr, "perfil_pmpi: no se pudo crear %s\n", nombre);
+    free(texto);
+
+    if (rango_mundo == 0)
+        printf("perfil_pmpi: MPI media %.6f s max %.6f s (proc %d), computo max/media = %.3f -> %s\n",
+               suma[1] / tamano_mundo, max[1].valor, max[1].rango,
+               suma[2] > 0 ? max[2].valor * tamano_mundo / suma[2] : 0.0, nombre);
+
+    for (i = 0; i < GRUPOS_CACHE; i++)
+        if (cache_grupos[i].grupo != MPI_GROUP_NULL)
+            PMPI_Group_free(&cache_grupos[i].grupo);
+    if (grupo_mundo != MPI_GROUP_NULL)
+        PMPI_Group_free(&grupo_mundo);
+    free(pares);
+    pares = NULL;
+    free(copias_trabajo);
+    free(estados_trabajo);
+
+    return PMPI_Finalize();
+}
+
+/* ---------------------------------------------------------------
+ * Punto a punto
+ * --------------------------------------------------------------- */
+int MPI_Send(const void *buf, int cuenta, MPI_Datatype tipo, int destino, int etiqueta, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Send(buf, cuenta, tipo, destino, etiqueta, comm);
+    long long bytes = bytes_de(cuenta, tipo);
+
+    t = PMPI_Wtime() - t;
+    registrar(P_SEND, bytes, t);
+    acreditar_envio(rango_en_mundo(destino, comm), bytes, t);
+    return rc;
+}
+
+int MPI_Recv(void *buf, int cuenta, MPI_Datatype tipo, int origen, int etiqueta, MPI_Comm comm,
+             MPI_Status *estado)
+{
+    MPI_Status propio;
+    MPI_Status *e = (estado == MPI_STATUS_IGNORE) ? &propio : estado;
+    double t = PMPI_Wtime();
+    int rc = PMPI_Recv(buf, cuenta, tipo, origen, etiqueta, comm, e);
+    long long bytes;
+
+    t = PMPI_Wtime() - t;
+    bytes = bytes_recibidos(e);
+    registrar(P_RECV, bytes, t);
+    acreditar_recibo(rango_en_mundo(e->MPI_SOURCE, comm), bytes, t);
+    return rc;
+}
+
+/* Isend/Irecv: la llamada cuenta los bytes publicados; el par se acredita al completarse */
+int MPI_Isend(const void *buf, int cuenta, MPI_Datatype tipo, int destino, int etiqueta, MPI_Comm comm,
+              MPI_Request *req)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Isend(buf, cuenta, tipo, destino, etiqueta, comm, req);
+    long long bytes = bytes_de(cuenta, tipo);
+
+    t = PMPI_Wtime() - t;
+    registrar(P_ISEND, bytes, t);
+    publicar(*req, comm, destino, 0, 0, bytes, t);
+    return rc;
+}
+
+int MPI_Irecv(void *buf, int cuenta, MPI_Datatype tipo, int origen, int etiqueta, MPI_Comm comm,
+              MPI_Request *req)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Irecv(buf, cuenta, tipo, origen, etiqueta, comm, req);
+    long long bytes = bytes_de(cuenta, tipo);
+
+    t = PMPI_Wtime() - t;
+    registrar(P_IRECV, bytes, t);
+    publicar(*req, comm, origen, 1, 0, bytes, t);
+    return rc;
+}
+
+int MPI_Send_init(const void *buf, int cuenta, MPI_Datatype tipo, int destino, int etiqueta, MPI_Comm comm,
+                  MPI_Request *req)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Send_init(buf, cuenta, tipo, destino, etiqueta, comm, req);
+
+    registrar(P_SEND_INIT, 0, PMPI_Wtime() - t);
+    agregar_peticion(*req, comm, rango_en_mundo(destino, comm), 0, 1, bytes_de(cuenta, tipo));
+    return rc;
+}
+
+int MPI_Recv_init(void *buf, int cuenta, MPI_Datatype tipo, int origen, int etiqueta, MPI_Comm comm,
+                  MPI_Request *req)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Recv_init(buf, cuenta, tipo, origen, etiqueta, comm, req);
+
+    registrar(P_RECV_INIT, 0, PMPI_Wtime() - t);
+    agregar_peticion(*req, comm, rango_en_mundo(origen, comm), 1, 1, bytes_de(cuenta, tipo));
+    return rc;
+}
+
+/* Activa una peticion persistente y devuelve sus bytes publicados */
+static long long activar(MPI_Request req)
+{
+    int i = buscar_peticion(req);
+
+    if (i < 0)
+        return 0;
+    peticiones[i].activa = 1;
+    return peticiones[i].bytes;
+}
+
+int MPI_Start(MPI_Request *req)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Start(req);
+    long long bytes;
+
+    t = PMPI_Wtime() - t;
+    bytes = activar(*req);
+    registrar(P_START, bytes, t);
+    return rc;
+}
+
+int MPI_Startall(int cuenta, MPI_Request reqs[])
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Startall(cuenta, reqs), i;
+    long long bytes = 0;
+
+    t = PMPI_Wtime() - t;
+    for (i = 0; i < cuenta; i++)
+        bytes += activar(reqs[i]);
+    registrar(P_STARTALL, bytes, t);
+    return rc;
+}
+
+int MPI_Sendrecv(const void *sbuf, int scuenta, MPI_Datatype stipo, int destino, int setiqueta,
+                 void *rbuf, int rcuenta, MPI_Datatype rtipo, int origen, int retiqueta,
+                 MPI_Comm comm, MPI_Status *estado)
+{
+    MPI_Status propio;
+    MPI_Status *e = (estado == MPI_STATUS_IGNORE) ? &propio : estado;
+    double t = PMPI_Wtime();
+    int rc = PMPI_Sendrecv(sbuf, scuenta, stipo, destino, setiqueta,
+                           rbuf, rcuenta, rtipo, origen, retiqueta, comm, e);
+    long long benv = bytes_de(scuenta, stipo), brec;
+
+    t = PMPI_Wtime() - t;
+    brec = bytes_recibidos(e);
+    registrar(P_SENDRECV, benv + brec, t);
+    acreditar_envio(rango_en_mundo(destino, comm), benv, 0.5 * t);
+    acreditar_recibo(rango_en_mundo(e->MPI_SOURCE, comm), brec, 0.5 * t);
+    return rc;
+}
+
+/*
+ * Esperas: las peticiones se buscan antes de la llamada (al completarse una
+ * no persistente su manejador pasa a MPI_REQUEST_NULL) y se usan estados
+ * propios si el llamador pasa MPI_STATUS(ES)_IGNORE, para conocer el origen.
+ */
+int MPI_Wait(MPI_Request *req, MPI_Status *estado)
+{
+    MPI_Status propio;
+    MPI_Status *e = (estado == MPI_STATUS_IGNORE) ? &propio : estado;
+    int i = buscar_peticion(*req), rc;
+    double t = PMPI_Wtime();
+
+    rc = PMPI_Wait(req, e);
+    t = PMPI_Wtime() - t;
+    registrar(P_WAIT, 0, t);
+    if (i >= 0)
+        completar_peticion(i, e, t);
+    return rc;
+}
+
+/* Copia los manejadores antes de esperar; devuelve cuantos estan registrados */
+static int copiar_peticiones(int cuenta, const MPI_Request reqs[])
+{
+    int k, registradas = 0;
+
+    for (k = 0; k < cuenta; k++)
+    {
+        copias_trabajo[k] = reqs[k];
+        if (buscar_peticion(reqs[k]) >= 0)
+            registradas++;
+    }
+    return registradas;
+}
+
+int MPI_Waitall(int cuenta, MPI_Request reqs[], MPI_Status estados[])
+{
+    MPI_Status *e = estados;
+    int k, i, rc, registradas;
+    double t;
+
+    if (!preparar_trabajo(cuenta))
+    {
+        t = PMPI_Wtime();
+        rc = PMPI_Waitall(cuenta, reqs, estados);
+        registrar(P_WAITALL, 0, PMPI_Wtime() - t);
+        return rc;
+    }
+    if (e == MPI_STATUSES_IGNORE)
+        e = estados_trabajo;
+    registradas = copiar_peticiones(cuenta, reqs);
+
+    t = PMPI_Wtime();
+    rc = PMPI_Waitall(cuenta, reqs, e);
+    t = PMPI_Wtime() - t;
+    registrar(P_WAITALL, 0, t);
+
+    /* el tiempo bloqueado se reparte por igual entre las peticiones registradas */
+    if (registradas > 0)
+        for (k = 0; k < cuenta; k++)
+            if ((i = buscar_peticion(copias_trabajo[k])) >= 0)
+                completar_peticion(i, &e[k], t / registradas);
+    return rc;
+}
+
+int MPI_Waitany(int cuenta, MPI_Request reqs[], int *indice, MPI_Status *estado)
+{
+    MPI_Status propio;
+    MPI_Status *e = (estado == MPI_STATUS_IGNORE) ? &propio : estado;
+    int i, rc;
+    double t;
+
+    if (!preparar_trabajo(cuenta))
+    {
+        t = PMPI_Wtime();
+        rc = PMPI_Waitany(cuenta, reqs, indice, estado);
+        registrar(P_WAITANY, 0, PMPI_Wtime() - t);
+        return rc;
+    }
+    copiar_peticiones(cuenta, reqs);
+
+    t = PMPI_Wtime();
+    rc = PMPI_Waitany(cuenta, reqs, indice, e);
+    t = PMPI_Wtime() - t;
+    registrar(P_WAITANY, 0, t);
+    if (*indice != MPI_UNDEFINED && (i = buscar_peticion(copias_trabajo[*indice])) >= 0)
+        completar_peticion(i, e, t);
+    return rc;
+}
+
+/* Completa las peticiones copiadas que MPI_Waitsome/MPI_Testsome reporta en 'indices' */
+static void completar_algunas(int completadas, const int indices[], const MPI_Status e[], double tiempo)
+{
+    int k, i, registradas = 0;
+
+    if (completadas == MPI_UNDEFINED)
+        return;
+    for (k = 0; k < completadas; k++)
+        if (buscar_peticion(copias_trabajo[indices[k]]) >= 0)
+            registradas++;
+    for (k = 0; k < completadas && registradas > 0; k++)
+        if ((i = buscar_peticion(copias_trabajo[indices[k]])) >= 0)
+            completar_peticion(i, &e[k], tiempo / registradas);
+}
+
+int MPI_Waitsome(int cuenta, MPI_Request reqs[], int *completadas, int indices[], MPI_Status estados[])
+{
+    MPI_Status *e = estados;
+    int rc;
+    double t;
+
+    if (!preparar_trabajo(cuenta))
+    {
+        t = PMPI_Wtime();
+        rc = PMPI_Waitsome(cuenta, reqs, completadas, indices, estados);
+        registrar(P_WAITSOME, 0, PMPI_Wtime() - t);
+        return rc;
+    }
+    if (e == MPI_STATUSES_IGNORE)
+        e = estados_trabajo;
+    copiar_peticiones(cuenta, reqs);
+
+    t = PMPI_Wtime();
+    rc = PMPI_Waitsome(cuenta, reqs, completadas, indices, e);
+    t = PMPI_Wtime() - t;
+    registrar(P_WAITSOME, 0, t);
+    completar_algunas(*completadas, indices, e, t);
+    return rc;
+}
+
+/* Pruebas: igual que las esperas, pero solo se completa lo que la llamada reporta */
+int MPI_Test(MPI_Request *req, int *lista, MPI_Status *estado)
+{
+    MPI_Status propio;
+    MPI_Status *e = (estado == MPI_STATUS_IGNORE) ? &propio : estado;
+    int i = buscar_peticion(*req), rc;
+    double t = PMPI_Wtime();
+
+    rc = PMPI_Test(req, lista, e);
+    t = PMPI_Wtime() - t;
+    registrar(P_TEST, 0, t);
+    if (*lista && i >= 0)
+        completar_peticion(i, e, t);
+    return rc;
+}
+
+int MPI_Testall(int cuenta, MPI_Request reqs[], int *lista, MPI_Status estados[])
+{
+    MPI_Status *e = estados;
+    int k, i, rc, registradas;
+    double t;
+
+    if (!preparar_trabajo(cuenta))
+    {
+        t = PMPI_Wtime();
+        rc = PMPI_Testall(cuenta, reqs, lista, estados);
+        registrar(P_TESTALL, 0, PMPI_Wtime() - t);
+        return rc;
+    }
+    if (e == MPI_STATUSES_IGNORE)
+        e = estados_trabajo;
+    registradas = copiar_peticiones(cuenta, reqs);
+
+    t = PMPI_Wtime();
+    rc = PMPI_Testall(cuenta, reqs, lista, e);
+    t = PMPI_Wtime() - t;
+    registrar(P_TESTALL, 0, t);
+    if (*lista && registradas > 0)
+        for (k = 0; k < cuenta; k++)
+            if ((i = buscar_peticion(copias_trabajo[k])) >= 0)
+                completar_peticion(i, &e[k], t / registradas);
+    return rc;
+}
+
+int MPI_Testany(int cuenta, MPI_Request reqs[], int *indice, int *lista, MPI_Status *estado)
+{
+    MPI_Status propio;
+    MPI_Status *e = (estado == MPI_STATUS_IGNORE) ? &propio : estado;
+    int i, rc;
+    double t;
+
+    if (!preparar_trabajo(cuenta))
+    {
+        t = PMPI_Wtime();
+        rc = PMPI_Testany(cuenta, reqs, indice, lista, estado);
+        registrar(P_TESTANY, 0, PMPI_Wtime() - t);
+        return rc;
+    }
+    copiar_peticiones(cuenta, reqs);
+
+    t = PMPI_Wtime();
+    rc = PMPI_Testany(cuenta, reqs, indice, lista, e);
+    t = PMPI_Wtime() - t;
+    registrar(P_TESTANY, 0, t);
+    if (*lista && *indice != MPI_UNDEFINED && (i = buscar_peticion(copias_trabajo[*indice])) >= 0)
+        completar_peticion(i, e, t);
+    return rc;
+}
+
+int MPI_Testsome(int cuenta, MPI_Request reqs[], int *completadas, int indices[], MPI_Status estados[])
+{
+    MPI_Status *e = estados;
+    int rc;
+    double t;
+
+    if (!preparar_trabajo(cuenta))
+    {
+        t = PMPI_Wtime();
+        rc = PMPI_Testsome(cuenta, reqs, completadas, indices, estados);
+        registrar(P_TESTSOME, 0, PMPI_Wtime() - t);
+        return rc;
+    }
+    if (e == MPI_STATUSES_IGNORE)
+        e = estados_trabajo;
+    copiar_peticiones(cuenta, reqs);
+
+    t = PMPI_Wtime();
+    rc = PMPI_Testsome(cuenta, reqs, completadas, indices, e);
+    t = PMPI_Wtime() - t;
+    registrar(P_TESTSOME, 0, t);
+    completar_algunas(*completadas, indices, e, t);
+    return rc;
+}
+
+/* Empaquetado: copias locales, pero suelen pesar tanto como el envio */
+int MPI_Pack(const void *entrada, int cuenta, MPI_Datatype tipo, void *salida, int tam_salida, int *posicion,
+             MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Pack(entrada, cuenta, tipo, salida, tam_salida, posicion, comm);
+    registrar(P_PACK, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Unpack(const void *entrada, int tam_entrada, int *posicion, void *salida, int cuenta, MPI_Datatype tipo,
+               MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Unpack(entrada, tam_entrada, posicion, salida, cuenta, tipo, comm);
+    registrar(P_UNPACK, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+/* ---------------------------------------------------------------
+ * Colectivas (bytes = aporte de este proceso)
+ * --------------------------------------------------------------- */
+int MPI_Barrier(MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Barrier(comm);
+    registrar(P_BARRIER, 0, PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Bcast(void *buf, int cuenta, MPI_Datatype tipo, int raiz, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Bcast(buf, cuenta, tipo, raiz, comm);
+    registrar(P_BCAST, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Reduce(const void *sbuf, void *rbuf, int cuenta, MPI_Datatype tipo, MPI_Op op, int raiz,
+               MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Reduce(sbuf, rbuf, cuenta, tipo, op, raiz, comm);
+    registrar(P_REDUCE, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Allreduce(const void *sbuf, void *rbuf, int cuenta, MPI_Datatype tipo, MPI_Op op, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Allreduce(sbuf, rbuf, cuenta, tipo, op, comm);
+    registrar(P_ALLREDUCE, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+/* Colectivas no bloqueantes y persistentes: la espera queda en MPI_Wait* (sin par) */
+int MPI_Iallreduce(const void *sbuf, void *rbuf, int cuenta, MPI_Datatype tipo, MPI_Op op, MPI_Comm comm,
+                   MPI_Request *req)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Iallreduce(sbuf, rbuf, cuenta, tipo, op, comm, req);
+    registrar(P_IALLREDUCE, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+#if MPI_VERSION >= 4
+int MPI_Allreduce_init(const void *sbuf, void *rbuf, int cuenta, MPI_Datatype tipo, MPI_Op op, MPI_Comm comm,
+                       MPI_Info info, MPI_Request *req)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Allreduce_init(sbuf, rbuf, cuenta, tipo, op, comm, info, req);
+    registrar(P_ALLREDUCE_INIT, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+#elif (defined(OMPI_HAVE_MPI_EXT_PCOLLREQ) && OMPI_HAVE_MPI_EXT_PCOLLREQ) || \
+      (defined(MPICH_NUMVERSION) && MPICH_NUMVERSION >= 30300000)
+/* la version previa a MPI 4 que usa minimos_cuadrados; se cuenta como MPI_Allreduce_init */
+int MPIX_Allreduce_init(const void *sbuf, void *rbuf, int cuenta, MPI_Datatype tipo, MPI_Op op, MPI_Comm comm,
+                        MPI_Info info, MPI_Request *req)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPIX_Allreduce_init(sbuf, rbuf, cuenta, tipo, op, comm, info, req);
+    registrar(P_ALLREDUCE_INIT, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+#endif
+
+int MPI_Exscan(const void *sbuf, void *rbuf, int cuenta, MPI_Datatype tipo, MPI_Op op, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Exscan(sbuf, rbuf, cuenta, tipo, op, comm);
+    registrar(P_EXSCAN, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Gather(const void *sbuf, int scuenta, MPI_Datatype stipo, void *rbuf, int rcuenta,
+               MPI_Datatype rtipo, int raiz, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Gather(sbuf, scuenta, stipo, rbuf, rcuenta, rtipo, raiz, comm);
+    registrar(P_GATHER, bytes_de(scuenta, stipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Gatherv(const void *sbuf, int scuenta, MPI_Datatype stipo, void *rbuf, const int rcuentas[],
+                const int desplazamientos[], MPI_Datatype rtipo, int raiz, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Gatherv(sbuf, scuenta, stipo, rbuf, rcuentas, desplazamientos, rtipo, raiz, comm);
+    registrar(P_GATHERV, bytes_de(scuenta, stipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Allgather(const void *sbuf, int scuenta, MPI_Datatype stipo, void *rbuf, int rcuenta,
+                  MPI_Datatype rtipo, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Allgather(sbuf, scuenta, stipo, rbuf, rcuenta, rtipo, comm);
+    registrar(P_ALLGATHER, bytes_de(scuenta, stipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Allgatherv(const void *sbuf, int scuenta, MPI_Datatype stipo, void *rbuf, const int rcuentas[],
+                   const int desplazamientos[], MPI_Datatype rtipo, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Allgatherv(sbuf, scuenta, stipo, rbuf, rcuentas, desplazamientos, rtipo, comm);
+    registrar(P_ALLGATHERV, bytes_de(scuenta, stipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Scatter(const void *sbuf, int scuenta, MPI_Datatype stipo, void *rbuf, int rcuenta,
+                MPI_Datatype rtipo, int raiz, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Scatter(sbuf, scuenta, stipo, rbuf, rcuenta, rtipo, raiz, comm);
+    registrar(P_SCATTER, bytes_de(rcuenta, rtipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Alltoall(const void *sbuf, int scuenta, MPI_Datatype stipo, void *rbuf, int rcuenta,
+                 MPI_Datatype rtipo, MPI_Comm comm)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Alltoall(sbuf, scuenta, stipo, rbuf, rcuenta, rtipo, comm);
+    int size;
+
+    PMPI_Comm_size(comm, &size);
+    registrar(P_ALLTOALL, bytes_de(scuenta, stipo) * size, PMPI_Wtime() - t);
+    return rc;
+}
+
+/* Vecindario: se acredita a cada vecino lo enviado y recibido; el tiempo se reparte */
+int MPI_Neighbor_alltoallw(const void *sbuf, const int scuentas[], const MPI_Aint sdespl[],
+                           const MPI_Datatype stipos[], void *rbuf, const int rcuentas[],
+                           const MPI_Aint rdespl[], const MPI_Datatype rtipos[], MPI_Comm comm)
+{
+    int fuentes[VECINOS_MAX], destinos[VECINOS_MAX], nf = 0, nd = 0, k, conocidos, rc;
+    long long benv = 0, brec, total = 0;
+    double t;
+
+    conocidos = vecinos_topologia(comm, fuentes, &nf, destinos, &nd);
+    t = PMPI_Wtime();
+    rc = PMPI_Neighbor_alltoallw(sbuf, scuentas, sdespl, stipos, rbuf, rcuentas, rdespl, rtipos, comm);
+    t = PMPI_Wtime() - t;
+    if (conocidos)
+    {
+        for (k = 0; k < nd; k++)
+        {
+            benv = bytes_de(scuentas[k], stipos[k]);
+            total += benv;
+            acreditar_envio(rango_en_mundo(destinos[k], comm), benv, t / (nf + nd));
+        }
+        for (k = 0; k < nf; k++)
+        {
+            brec = bytes_de(rcuentas[k], rtipos[k]);
+            acreditar_recibo(rango_en_mundo(fuentes[k], comm), brec, t / (nf + nd));
+        }
+    }
+    registrar(P_NEIGHBOR_ALLTOALLW, total, t);
+    return rc;
+}
+
+/* ---------------------------------------------------------------
+ * Creacion de comunicadores (colectivas que pueden bloquear)
+ * --------------------------------------------------------------- */
+int MPI_Comm_dup(MPI_Comm comm, MPI_Comm *nuevo)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Comm_dup(comm, nuevo);
+    registrar(P_COMM_DUP, 0, PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Comm_split(MPI_Comm comm, int color, int clave, MPI_Comm *nuevo)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Comm_split(comm, color, clave, nuevo);
+    registrar(P_COMM_SPLIT, 0, PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Comm_split_type(MPI_Comm comm, int tipo_division, int clave, MPI_Info info, MPI_Comm *nuevo)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Comm_split_type(comm, tipo_division, clave, info, nuevo);
+    registrar(P_COMM_SPLIT_TYPE, 0, PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_Cart_create(MPI_Comm comm, int ndims, const int dims[], const int periodos[], int reordenar,
+                    MPI_Comm *nuevo)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_Cart_create(comm, ndims, dims, periodos, reordenar, nuevo);
+    registrar(P_CART_CREATE, 0, PMPI_Wtime() - t);
+    return rc;
+}
+
+/* ---------------------------------------------------------------
+ * E/S (salida_mpi.c)
+ * --------------------------------------------------------------- */
+int MPI_File_open(MPI_Comm comm, const char *nombre, int modo, MPI_Info info, MPI_File *archivo)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_File_open(comm, nombre, modo, info, archivo);
+    registrar(P_FILE_OPEN, 0, PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_File_set_size(MPI_File archivo, MPI_Offset tam)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_File_set_size(archivo, tam);
+    registrar(P_FILE_SET_SIZE, 0, PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_File_write_at_all(MPI_File archivo, MPI_Offset desplazamiento, const void *buf, int cuenta,
+                          MPI_Datatype tipo, MPI_Status *estado)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_File_write_at_all(archivo, desplazamiento, buf, cuenta, tipo, estado);
+    registrar(P_FILE_WRITE_AT_ALL, bytes_de(cuenta, tipo), PMPI_Wtime() - t);
+    return rc;
+}
+
+int MPI_File_close(MPI_File *archivo)
+{
+    double t = PMPI_Wtime();
+    int rc = PMPI_File_close(archivo);
+    registrar(P_FILE_CLOSE, 0, PMPI_Wtime() - t);
+    return rc;
+}
@@ -0,0 +1,158 @@
+/*
+ ============================================================================
+ Name        : salida_mpi.c
+ Description : Implementacion de la escritura colectiva (ver salida_mpi.h).
+ ============================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "salida_mpi.h"
+
+#define SALIDA_TROZO_MAX (1LL << 30) /* bytes por llamada a MPI_File_write_at_all */
+
+static int reservar(salida_t *s, size_t bytes)
+{
+    size_t nueva;
+    char *tmp;
+
+    if (s->usados + bytes <= s->capacidad)
+        return MPI_SUCCESS;
+    nueva = (s->capacidad > 0) ? s->capacidad : SALIDA_CAPACIDAD_INICIAL;
+    while (nueva < s->usados + bytes)
+        nueva *= 2;
+    tmp = (char *)realloc(s->buffer, nueva);
+    if (tmp == NULL)
+        return MPI_ERR_NO_MEM;
+    s->buffer = tmp;
+    s->capacidad = nueva;
+    return MPI_SUCCESS;
+}
+
+int salida_abrir(salida_t *s, const char *nombre, MPI_Comm comm)
+{
+    MPI_Info info;
+    int rc;
+
+    s->comm = comm;
+    s->base = 0;
+    s->buffer = NULL;
+    s->usados = s->capacidad = 0;
+
+    /* sugerencias para ROMIO: agregacion en dos fases para las escrituras colectivas */
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "romio_cb_write", "enable");
+    MPI_Info_set(info, "romio_no_indep_rw", "true");
+
+    rc = MPI_File_open(comm, nombre, MPI_MODE_CREATE | MPI_MODE_WRONLY, info, &s->archivo);
+    MPI_Info_free(&info);
+    if (rc != MPI_SUCCESS)
+        return rc;
+
+    /* truncar lo que hubiera de una ejecucion anterior (una sola operacion de metadatos) */
+    return MPI_File_set_size(s->archivo, 0);
+}
+
+int salida_agregar(salida_t *s, const void *datos, size_t bytes)
+{
+    int rc = reservar(s, bytes);
+    if (rc != MPI_SUCCESS)
+        return rc;
+    memcpy(s->buffer + s->usados, datos, bytes);
+    s->usados += bytes;
+    return MPI_SUCCESS;
+}
+
+int salida_printf(salida_t *s, const char *formato, ...)
+{
+    va_list args;
+    int n, rc;
+
+    va_start(args, formato);
+    n = vsnprintf(NULL, 0, formato, args);
+    va_end(args);
+    if (n < 0)
+        return MPI_ERR_OTHER;
+
+    /* +1 para el '\0' que escribe vsnprintf y que no se guarda */
+    rc = reservar(s, (size_t)n + 1);
+    if (rc != MPI_SUCCESS)
+        return rc;
+    va_start(args, formato);
+    vsnprintf(s->buffer + s->usados, (size_t)n + 1, formato, args);
+    va_end(args);
+    s->usados += (size_t)n;
+    return MPI_SUCCESS;
+}
+
+int salida_cabecera(salida_t *s, uint32_t tam_registro)
+{
+    salida_cabecera_t cabecera;
+    int rango, size;
+
+    MPI_Comm_rank(s->comm, &rango);
+    if (rango != 0)
+        return MPI_SUCCESS;
+    MPI_Comm_size(s->comm, &size);
+    memcpy(cabecera.magia, SALIDA_MAGIA, 4);
+    cabecera.version = SALIDA_VERSION;
+    cabecera.tam_registro = tam_registro;
+    cabecera.num_procesos = (uint32_t)size;
+    return salida_agregar(s, &cabecera, sizeof(cabecera));
+}
+
+int salida_vaciar(salida_t *s)
+{
+    long long mis_bytes = (long long)s->usados, previos = 0, total = 0, escritos, trozo;
+    int rango, rondas, rondas_max, k, rc;
+
+    MPI_Comm_rank(s->comm, &rango);
+
+    /* desplazamiento = bytes de los procesos de menor rango (Exscan deja basura en el 0) */
+    rc = MPI_Exscan(&mis_bytes, &previos, 1, MPI_LONG_LONG, MPI_SUM, s->comm);
+    if (rc != MPI_SUCCESS)
+        return rc;
+    if (rango == 0)
+        previos = 0;
+    rc = MPI_Allreduce(&mis_bytes, &total, 1, MPI_LONG_LONG, MPI_SUM, s->comm);
+    if (rc != MPI_SUCCESS || total == 0)
+        return rc;
+
+    /* la cuenta de MPI_File_write_at_all es int: buffers grandes van en varias rondas,
+     * todas colectivas, asi que todos hacen tantas como el proceso con mas datos */
+    rondas = (int)((mis_bytes + SALIDA_TROZO_MAX - 1) / SALIDA_TROZO_MAX);
+    rc = MPI_Allreduce(&rondas, &rondas_max, 1, MPI_INT, MPI_MAX, s->comm);
+    if (rc != MPI_SUCCESS)
+        return rc;
+
+    escritos = 0;
+    for (k = 0; k < rondas_max; k++)
+    {
+        int rc_ronda;
+
+        trozo = mis_bytes - escritos;
+        if (trozo > SALIDA_TROZO_MAX)
+            trozo = SALIDA_TROZO_MAX;
+        rc_ronda = MPI_File_write_at_all(s->archivo, s->base + (MPI_Offset)(previos + escritos),
+                                         s->buffer + escritos, (int)trozo, MPI_BYTE, MPI_STATUS_IGNORE);
+        if (rc == MPI_SUCCESS)
+            rc = rc_ronda;
+        escritos += trozo;
+    }
+    s->base += (MPI_Offset)total;
+    s->usados = 0;
+    return rc;
+}
+
+int salida_cerrar(salida_t *s)
+{
+    int rc = salida_vaciar(s);
+
+    MPI_File_close(&s->archivo);
+    free(s->buffer);
+    s->buffer = NULL;
+    s->capacidad = 0;
+    return rc;
+}
@@ -0,0 +1,62 @@
+/*
+ ============================================================================
+ Name        : salida_mpi.h
+ Description : Escritura colectiva de resultados con MPI-IO. El archivo se
+               abre una sola vez para todo el comunicador (MPI_File_open) y
+               cada proceso acumula sus registros en un buffer local; al
+               vaciar, MPI_Exscan calcula el desplazamiento de cada proceso
+               y MPI_File_write_at_all escribe todo en una operacion
+               colectiva (la implementacion MPI-IO agrega las escrituras).
+               Los datos quedan en el archivo en orden de rango.
+ ============================================================================
+*/
+
+#ifndef SALIDA_MPI_H
+#define SALIDA_MPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mpi.h"
+
+#define SALIDA_CAPACIDAD_INICIAL 65536
+
+/* Cabecera de los archivos binarios: magia "MPIR", version, tamano de registro */
+#define SALIDA_MAGIA "MPIR"
+#define SALIDA_VERSION 1
+
+typedef struct
+{
+    char magia[4];
+    uint32_t version;
+    uint32_t tam_registro;  /* bytes por registro                  */
+    uint32_t num_procesos;  /* procesos que escribieron el archivo */
+} salida_cabecera_t;
+
+typedef struct
+{
+    MPI_Comm comm;
+    MPI_File archivo;
+    MPI_Offset base; /* fin de lo ya escrito en el archivo */
+    char *buffer;
+    size_t usados, capacidad;
+} salida_t;
+
+/* Colectiva: crea o trunca 'nombre' */
+int salida_abrir(salida_t *s, const char *nombre, MPI_Comm comm);
+
+/* Local: agrega bytes al buffer del proceso */
+int salida_agregar(salida_t *s, const void *datos, size_t bytes);
+
+/* Local: agrega texto con formato al buffer del proceso */
+int salida_printf(salida_t *s, const char *formato, ...);
+
+/* Local: el proceso 0 agrega la cabecera binaria (llamar antes de los registros) */
+int salida_cabecera(salida_t *s, uint32_t tam_registro);
+
+/* Colectiva: escribe los buffers de todos los procesos a continuacion de lo anterior */
+int salida_vaciar(salida_t *s);
+
+/* Colectiva: vacia, cierra el archivo y libera el buffer */
+int salida_cerrar(salida_t *s);
+
+#endif /* SALIDA_MPI_H */
@@ -0,0 +1,61 @@
+/*
+ ============================================================================
+ Name        : tiempo_mpi.h
+ Description : Lineas uniformes con los tiempos de un programa, que lee
+               escalamiento.sh para armar las tablas de escalamiento:
+                 TIEMPO_PARED programa=<nombre> procesos=<P> segundos=<t>
+                 TIEMPO_NUCLEO programa=<nombre> procesos=<P> segundos=<t>
+                               [repeticiones=<k> us_por_repeticion=<u>]
+               PARED va desde MPI_Init; NUCLEO solo cuenta la region de
+               calculo y comunicacion que mide cada programa (sin lecturas
+               seriales, calibraciones ni lineas base). Los tiempos son el
+               maximo entre los procesos de 'comm'.
+ ============================================================================
+*/
+
+#ifndef TIEMPO_MPI_H
+#define TIEMPO_MPI_H
+
+#include <stdio.h>
+#include "mpi.h"
+
+/* Colectiva: reduce el tiempo desde 't_inicio' al proceso 0 y lo imprime */
+static inline void reportar_tiempo_pared(const char *programa, double t_inicio, MPI_Comm comm)
+{
+    double t = MPI_Wtime() - t_inicio, t_max;
+    int rango, tamano;
+
+    MPI_Comm_rank(comm, &rango);
+    MPI_Comm_size(comm, &tamano);
+    MPI_Reduce(&t, &t_max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    if (rango == 0)
+    {
+        printf("TIEMPO_PARED programa=%s procesos=%d segundos=%.6f\n", programa, tamano, t_max);
+        fflush(stdout);
+    }
+}
+
+/*
+ * Colectiva: 'segundos' es el tiempo local de la region medida. Si
+ * 'repeticiones' > 0 (p. ej. intercambios de halo) se agrega el tiempo
+ * por repeticion.
+ */
+static inline void reportar_tiempo_nucleo(const char *programa, double segundos, long repeticiones, MPI_Comm comm)
+{
+    double t_max;
+    int rango, tamano;
+
+    MPI_Comm_rank(comm, &rango);
+    MPI_Comm_size(comm, &tamano);
+    MPI_Reduce(&segundos, &t_max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    if (rango == 0)
+    {
+        printf("TIEMPO_NUCLEO programa=%s procesos=%d segundos=%.6f", programa, tamano, t_max);
+        if (repeticiones > 0)
+            printf(" repeticiones=%ld us_por_repeticion=%.3f", repeticiones, t_max / repeticiones * 1e6);
+        printf("\n");
+        fflush(stdout);
+    }
+}
+
+#endif /* TIEMPO_MPI_H */